@@ -0,0 +1,350 @@
+#include <iostream>
+#include <stdexcept>
+#include <fstream>
+#include <vector>
+#include <cmath>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief The activation functions which could be chosen for the layers of the network.
+ *
+ */
+enum class activation_type
+{
+    sigmoid,
+    tanh,
+    relu,
+    leaky_relu,
+    softmax
+};
+
+/**
+ * @brief Sigmoid activation policy, g(z) = 1 / (1 + exp(-z)).
+ *
+ */
+class sigmoid_activation
+{
+public:
+    /**
+     * @brief The activation type which this policy implements.
+     *
+     */
+    static constexpr activation_type type = activation_type::sigmoid;
+
+    /**
+     * @brief Softmax is the only activation which needs all the neurons of the layer.
+     *
+     */
+    static constexpr bool normalizes_layer = false;
+
+    /**
+    * @brief Static member function to compute the activation of a neuron.
+    *
+    * @param z Weighted sum of the inputs of the neuron.
+    * @return double Activation of the neuron.
+    */
+    static double activate(const double &);
+
+    /**
+    * @brief Static member function to compute the derivative of the activation function based on the activation itself.
+    *
+    * @param a Activation of the neuron.
+    * @return double Derivative of the activation function.
+    */
+    static double derivative(const double &);
+};
+
+/**
+ * @brief Hyperbolic tangent activation policy, g(z) = tanh(z).
+ *
+ */
+class tanh_activation
+{
+public:
+    static constexpr activation_type type = activation_type::tanh;
+    static constexpr bool normalizes_layer = false;
+    static double activate(const double &);
+    static double derivative(const double &);
+};
+
+/**
+ * @brief Rectified linear unit activation policy, g(z) = max(0, z).
+ *
+ */
+class relu_activation
+{
+public:
+    static constexpr activation_type type = activation_type::relu;
+    static constexpr bool normalizes_layer = false;
+    static double activate(const double &);
+    static double derivative(const double &);
+};
+
+/**
+ * @brief Leaky rectified linear unit activation policy, g(z) = z for z > 0 and g(z) = slope * z otherwise.
+ *
+ */
+class leaky_relu_activation
+{
+public:
+    static constexpr activation_type type = activation_type::leaky_relu;
+    static constexpr bool normalizes_layer = false;
+
+    /**
+     * @brief Slope of the function for negative inputs.
+     *
+     */
+    static constexpr double slope = 0.01;
+
+    static double activate(const double &);
+    static double derivative(const double &);
+};
+
+/**
+ * @brief Softmax activation policy, g(z_i) = exp(z_i) / sum_j(exp(z_j)). It can only be used for the output layer.
+ *
+ */
+class softmax_activation
+{
+public:
+    static constexpr activation_type type = activation_type::softmax;
+    static constexpr bool normalizes_layer = true;
+
+    /**
+    * @brief Static member function to compute the unnormalized activation of a neuron. The maximum weighted sum of the layer is subtracted for numerical stability.
+    *
+    * @param z Weighted sum of the inputs of the neuron minus the maximum weighted sum of the layer.
+    * @return double Unnormalized activation of the neuron.
+    */
+    static double activate(const double &);
+    static double derivative(const double &);
+};
+
+/**
+ * @brief Converts the name of an activation function (sigmoid, tanh, relu, leaky_relu or softmax) to its type.
+ *
+ * @param s The name of the activation function.
+ * @return activation_type Type of the activation function.
+ */
+activation_type to_activation_type(const string &);
+
+/**
+ * @brief Overloaded binary operator << to easily print out the name of an activation function to a stream.
+ *
+ * @param out Output stream.
+ * @param m The activation type.
+ * @return ostream& The name of the activation function.
+ */
+ostream &operator<<(ostream &, const activation_type &);
+
+class read_activations
+{
+
+public:
+    /**
+    * @brief Construct a new read activations::read activations object which reads the activation function of each layer (except the input layer) from a file.
+    *
+    * @param filename The file name that contains the activation functions.
+    */
+    read_activations(const string &);
+
+    /**
+    * @brief Member function to obtain (but not modify) the read activation functions.
+    *
+    * @return vector<activation_type> Activation function of each layer except the input layer.
+    */
+    vector<activation_type> get_values() const;
+
+    /**
+     * @brief Error if the name is not a known activation function.
+     *
+     */
+    class not_activation : public invalid_argument
+    {
+    public:
+        not_activation() : invalid_argument("Expected sigmoid, tanh, relu, leaky_relu or softmax!"){};
+    };
+
+    /**
+     * @brief Error if softmax is used for a hidden layer.
+     *
+     */
+    class hidden_softmax : public invalid_argument
+    {
+    public:
+        hidden_softmax() : invalid_argument("Softmax can only be used for the output layer!"){};
+    };
+
+    /**
+     * @brief Error if there is a problem with the file.
+     *
+     */
+    class invalid_file : public invalid_argument
+    {
+    public:
+        invalid_file() : invalid_argument(""){};
+    };
+
+private:
+    /**
+     * @brief A vector containing the activation function of each layer except the input layer.
+     *
+     */
+    vector<activation_type> values;
+};
+
+/**
+ * @brief Sigmoid function which is equal to y(x) = 1 / (1 + exp(-x)).
+ *
+ * @tparam T Template.
+ * @param x Input of the function.
+ * @return T Output of the function.
+ */
+template <typename T>
+T sigmoid(const T &);
+
+// ==============
+// Implementation
+// ==============
+
+double sigmoid_activation::activate(const double &z)
+{
+    return sigmoid(z);
+}
+
+double sigmoid_activation::derivative(const double &a)
+{
+    return a * (1 - a);
+}
+
+double tanh_activation::activate(const double &z)
+{
+    return tanh(z);
+}
+
+double tanh_activation::derivative(const double &a)
+{
+    return 1 - a * a;
+}
+
+double relu_activation::activate(const double &z)
+{
+    return z > 0 ? z : 0;
+}
+
+double relu_activation::derivative(const double &a)
+{
+    return a > 0 ? 1 : 0;
+}
+
+double leaky_relu_activation::activate(const double &z)
+{
+    return z > 0 ? z : slope * z;
+}
+
+double leaky_relu_activation::derivative(const double &a)
+{
+    return a > 0 ? 1 : slope; // The sign of the activation is the same as the sign of the input.
+}
+
+double softmax_activation::activate(const double &z)
+{
+    return exp(z);
+}
+
+double softmax_activation::derivative(const double &a)
+{
+    return a * (1 - a); // Diagonal of the Jacobian. Only used with cross-entropy in the output layer where the error is a - y.
+}
+
+activation_type to_activation_type(const string &s)
+{
+    if (s == "sigmoid")
+        return activation_type::sigmoid;
+    if (s == "tanh")
+        return activation_type::tanh;
+    if (s == "relu")
+        return activation_type::relu;
+    if (s == "leaky_relu")
+        return activation_type::leaky_relu;
+    if (s == "softmax")
+        return activation_type::softmax;
+    throw read_activations::not_activation();
+}
+
+ostream &operator<<(ostream &out, const activation_type &m)
+{
+    switch (m)
+    {
+    case activation_type::sigmoid:
+        out << "sigmoid";
+        break;
+    case activation_type::tanh:
+        out << "tanh";
+        break;
+    case activation_type::relu:
+        out << "relu";
+        break;
+    case activation_type::leaky_relu:
+        out << "leaky_relu";
+        break;
+    case activation_type::softmax:
+        out << "softmax";
+        break;
+    }
+    return out;
+}
+
+read_activations::read_activations(const string &filename)
+{
+    ifstream input(filename);
+    if (!input.is_open())
+    {
+        cout << "Error opening " << filename << " input file!";
+        throw invalid_file();
+    }
+    uint64_t line = 0;
+    string s;
+    while (getline(input, s))
+    {
+        line++;
+        if (!s.empty() && s.back() == '\r')
+            s.pop_back();
+        try
+        {
+            values.push_back(to_activation_type(s));
+        }
+        catch (const exception &e)
+        {
+            cout << "Error in line " << line << " " << filename << ": " << e.what() << '\n';
+            throw invalid_file();
+        }
+    }
+    // Softmax normalizes the whole layer, so its derivative is not a single number and it cannot be back propagated through a hidden layer.
+    for (uint64_t i = 0; i + 1 < values.size(); i++)
+    {
+        if (values[i] == activation_type::softmax)
+        {
+            cout << "Error in line " << i + 1 << " " << filename << ": " << hidden_softmax().what() << '\n';
+            throw invalid_file();
+        }
+    }
+    if (input.eof())
+        cout << "Reached end of " << filename << "\n";
+    input.close();
+}
+
+vector<activation_type> read_activations::get_values() const
+{
+    return values;
+}
+
+template <typename T>
+T sigmoid(const T &x)
+{
+    return 1 / (1 + exp(-x));
+}
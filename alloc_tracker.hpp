@@ -0,0 +1,202 @@
+#include <cstdlib>
+#include <new>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+// With -DNN_TRACK_ALLOC, the global operator new and delete are replaced by versions which count every allocation in the current phase of the profiler, including the aligned versions used for types with alignas() larger than that of malloc. The nothrow versions return a null pointer instead of throwing. This file should be included in only one source file of a program, after profiler.hpp.
+#ifdef NN_TRACK_ALLOC
+
+/**
+ * @brief Allocating memory with malloc and counting the allocation.
+ *
+ * @param size Size of the allocation.
+ * @return void* The allocated memory.
+ */
+void *tracked_allocation(size_t);
+
+/**
+ * @brief Allocating memory with aligned_alloc and counting the allocation.
+ *
+ * @param size Size of the allocation.
+ * @param alignment Alignment of the allocation (A power of 2).
+ * @return void* The allocated memory, which is released by free.
+ */
+void *tracked_aligned_allocation(size_t, align_val_t);
+
+void *operator new(size_t);
+void *operator new[](size_t);
+void *operator new(size_t, align_val_t);
+void *operator new[](size_t, align_val_t);
+void *operator new(size_t, const nothrow_t &) noexcept;
+void *operator new[](size_t, const nothrow_t &) noexcept;
+void *operator new(size_t, align_val_t, const nothrow_t &) noexcept;
+void *operator new[](size_t, align_val_t, const nothrow_t &) noexcept;
+void operator delete(void *) noexcept;
+void operator delete[](void *) noexcept;
+void operator delete(void *, size_t) noexcept;
+void operator delete[](void *, size_t) noexcept;
+void operator delete(void *, align_val_t) noexcept;
+void operator delete[](void *, align_val_t) noexcept;
+void operator delete(void *, size_t, align_val_t) noexcept;
+void operator delete[](void *, size_t, align_val_t) noexcept;
+void operator delete(void *, const nothrow_t &) noexcept;
+void operator delete[](void *, const nothrow_t &) noexcept;
+void operator delete(void *, align_val_t, const nothrow_t &) noexcept;
+void operator delete[](void *, align_val_t, const nothrow_t &) noexcept;
+
+// ==============
+// Implementation
+// ==============
+
+void *tracked_allocation(size_t size)
+{
+    profiler::instance().add_allocation(size);
+    void *p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+        throw bad_alloc();
+    return p;
+}
+
+void *tracked_aligned_allocation(size_t size, align_val_t alignment)
+{
+    profiler::instance().add_allocation(size);
+    size_t bytes = static_cast<size_t>(alignment);
+    // The size of aligned_alloc should be a multiple of the alignment.
+    void *p = aligned_alloc(bytes, size == 0 ? bytes : (size + bytes - 1) / bytes * bytes);
+    if (p == nullptr)
+        throw bad_alloc();
+    return p;
+}
+
+void *operator new(size_t size)
+{
+    return tracked_allocation(size);
+}
+
+void *operator new[](size_t size)
+{
+    return tracked_allocation(size);
+}
+
+void *operator new(size_t size, align_val_t alignment)
+{
+    return tracked_aligned_allocation(size, alignment);
+}
+
+void *operator new[](size_t size, align_val_t alignment)
+{
+    return tracked_aligned_allocation(size, alignment);
+}
+
+void *operator new(size_t size, const nothrow_t &) noexcept
+{
+    try
+    {
+        return tracked_allocation(size);
+    }
+    catch (const bad_alloc &e)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new[](size_t size, const nothrow_t &) noexcept
+{
+    try
+    {
+        return tracked_allocation(size);
+    }
+    catch (const bad_alloc &e)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new(size_t size, align_val_t alignment, const nothrow_t &) noexcept
+{
+    try
+    {
+        return tracked_aligned_allocation(size, alignment);
+    }
+    catch (const bad_alloc &e)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new[](size_t size, align_val_t alignment, const nothrow_t &) noexcept
+{
+    try
+    {
+        return tracked_aligned_allocation(size, alignment);
+    }
+    catch (const bad_alloc &e)
+    {
+        return nullptr;
+    }
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, align_val_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, align_val_t) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t, align_val_t) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, size_t, align_val_t) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, const nothrow_t &) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, const nothrow_t &) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, align_val_t, const nothrow_t &) noexcept
+{
+    free(p);
+}
+
+void operator delete[](void *p, align_val_t, const nothrow_t &) noexcept
+{
+    free(p);
+}
+
+#endif
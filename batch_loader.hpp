@@ -0,0 +1,348 @@
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <optional>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief A batch of instances which was gathered by the batch loader.
+ *
+ */
+struct loaded_batch
+{
+    /**
+     * @brief Features of the instances stored row by row, with the bias unit as the first column as in read_x (Aligned to 64 bytes).
+     *
+     */
+    const double *x = nullptr;
+
+    /**
+     * @brief The class of each instance (Starting from 1).
+     *
+     */
+    const uint64_t *classes = nullptr;
+
+    /**
+     * @brief Number of instances.
+     *
+     */
+    uint64_t rows = 0;
+};
+
+/**
+ * @brief Background thread which gathers the batches of an epoch into contiguous buffers while the previous batches are trained on. The rows of the train set are separate vectors, so reading them in the order of a (shuffled) list of instances is a gather from scattered memory; the loader copies the rows of each batch into a buffer aligned to 64 bytes, so the trainer reads one contiguous block. The buffers form a ring which hands the batches from the loader to the trainer without locks: the loader fills the next free buffer and publishes it by increasing a counter with a release store, and the trainer frees it by increasing another counter when it has finished with it. With two buffers, a batch is gathered while the other one is trained on. With a random number generator, the instances are shuffled at the start of each epoch by a Fisher-Yates shuffle keyed on the epoch, so every epoch visits the rows in a different order which only depends on the generator and the number of the epoch. The rows do not depend on the weights, so the loader continues with the first batches of the next epoch while the last batches of an epoch are trained on, and the trainer only waits for a batch if the gathering is slower than the training. All the buffers are allocated by the constructor.
+ *
+ */
+class batch_loader
+{
+
+public:
+    /**
+    * @brief Construct a new batch loader::batch loader object, allocate the buffers and start the loader thread.
+    *
+    * @param _x Features of the train set, with the bias unit as the first column.
+    * @param _classes The class of each instance of the train set (Starting from 1).
+    * @param _order The instances of an epoch in the order of the batches.
+    * @param _batch_rows Number of instances of a batch (The last batch of an epoch could be smaller).
+    * @param _slots Number of buffers of the ring (At least 2).
+    * @param _shuffle Random number generator of the order of each epoch (The order is not changed if empty).
+    * @param _first_epoch Number of the first epoch, which is the counter of its shuffle (For resumed runs).
+    */
+    batch_loader(const vector<vector<double>> &, const vector<uint64_t> &, const vector<uint64_t> &, const uint64_t &, const uint64_t & = 2, const optional<counter_rng> & = nullopt, const uint64_t & = 0);
+
+    /**
+    * @brief Destroy the batch loader::batch loader object and stop the loader thread.
+    *
+    */
+    ~batch_loader();
+
+    /**
+    * @brief Member function to obtain the next batch of the current epoch, waiting if it has not been gathered yet. The batch stays valid until release() is called.
+    *
+    * @return const loaded_batch* The batch (Null at the end of an epoch, and the next call returns the first batch of the next epoch).
+    */
+    const loaded_batch *next();
+
+    /**
+    * @brief Member function to give the buffer of the batch returned by next() back to the loader.
+    *
+    */
+    void release();
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of batches of an epoch.
+    *
+    * @return uint64_t Number of batches.
+    */
+    uint64_t get_batches_per_epoch() const;
+
+    /**
+    * @brief Member function to print the number of batches which were trained on, the number of them which the trainer waited for and the time it waited, and the number of batches for which the loader waited for a free buffer.
+    *
+    * @param out Output stream.
+    */
+    void print_statistics(ostream &) const;
+
+private:
+    /**
+    * @brief Loop of the loader thread, which gathers the batches of the epochs one after the other until the loader is destroyed.
+    *
+    */
+    void load();
+
+    /**
+     * @brief Features of the train set.
+     *
+     */
+    const vector<vector<double>> *x;
+
+    /**
+     * @brief The classes of the train set.
+     *
+     */
+    const vector<uint64_t> *classes;
+
+    /**
+     * @brief The instances of an epoch in the order of the batches.
+     *
+     */
+    vector<uint64_t> order;
+
+    /**
+     * @brief The instances in the order given to the constructor, which is shuffled for each epoch.
+     *
+     */
+    vector<uint64_t> initial_order;
+
+    /**
+     * @brief Random number generator of the order of each epoch.
+     *
+     */
+    optional<counter_rng> shuffle;
+
+    /**
+     * @brief Number of the first epoch.
+     *
+     */
+    uint64_t first_epoch = 0;
+
+    /**
+     * @brief Number of instances of a batch.
+     *
+     */
+    uint64_t batch_rows = 1;
+
+    /**
+     * @brief Number of buffers of the ring.
+     *
+     */
+    uint64_t slots = 2;
+
+    /**
+     * @brief Number of values of a row, including the bias unit.
+     *
+     */
+    uint64_t columns = 0;
+
+    /**
+     * @brief Distance between the buffers of the features in doubles, a multiple of 64 bytes.
+     *
+     */
+    uint64_t stride = 0;
+
+    /**
+     * @brief Memory of the buffers of the features.
+     *
+     */
+    vector<double> storage;
+
+    /**
+     * @brief The first buffer of the features, which is aligned to 64 bytes inside storage.
+     *
+     */
+    double *buffers = nullptr;
+
+    /**
+     * @brief The classes of the instances of each buffer.
+     *
+     */
+    vector<uint64_t> buffer_classes;
+
+    /**
+     * @brief The batch of each buffer.
+     *
+     */
+    vector<loaded_batch> batches;
+
+    /**
+     * @brief Number of batches of an epoch.
+     *
+     */
+    uint64_t batches_per_epoch = 0;
+
+    /**
+     * @brief Number of batches which the loader has gathered since it started. Written by the loader and read by the trainer, so it has its own cache line.
+     *
+     */
+    alignas(64) atomic<uint64_t> produced{0};
+
+    /**
+     * @brief Number of batches which the trainer has released since it started. Written by the trainer and read by the loader.
+     *
+     */
+    alignas(64) atomic<uint64_t> consumed{0};
+
+    /**
+     * @brief Number of batches of the current epoch which next() has returned.
+     *
+     */
+    uint64_t epoch_position = 0;
+
+    /**
+     * @brief Number of batches which the trainer had to wait for.
+     *
+     */
+    uint64_t stalls = 0;
+
+    /**
+     * @brief Time which the trainer waited for batches in nanoseconds.
+     *
+     */
+    uint64_t stall_ns = 0;
+
+    /**
+     * @brief Number of batches for which the loader waited for a free buffer.
+     *
+     */
+    atomic<uint64_t> full_waits{0};
+
+    /**
+     * @brief If the loader thread should finish.
+     *
+     */
+    atomic<bool> stopping{false};
+
+    /**
+     * @brief The loader thread.
+     *
+     */
+    thread loader;
+};
+
+// ==============
+// Implementation
+// ==============
+
+batch_loader::batch_loader(const vector<vector<double>> &_x, const vector<uint64_t> &_classes, const vector<uint64_t> &_order, const uint64_t &_batch_rows, const uint64_t &_slots, const optional<counter_rng> &_shuffle, const uint64_t &_first_epoch)
+    : x(&_x), classes(&_classes), order(_order), shuffle(_shuffle), first_epoch(_first_epoch), batch_rows(max<uint64_t>(_batch_rows, 1)), slots(max<uint64_t>(_slots, 2))
+{
+    if (shuffle)
+        initial_order = order;
+    batches_per_epoch = (order.size() + batch_rows - 1) / batch_rows;
+    columns = order.empty() ? 0 : (*x)[order[0]].size();
+    stride = (batch_rows * columns + 7) / 8 * 8;
+    storage.resize(slots * stride + 8);
+    buffers = storage.data() + ((64 - (uintptr_t)storage.data() % 64) % 64) / sizeof(double);
+    buffer_classes.resize(slots * batch_rows);
+    batches.resize(slots);
+    if (batches_per_epoch > 0)
+        loader = thread(&batch_loader::load, this);
+}
+
+batch_loader::~batch_loader()
+{
+    stopping = true;
+    if (loader.joinable())
+        loader.join();
+}
+
+const loaded_batch *batch_loader::next()
+{
+    if (epoch_position == batches_per_epoch)
+    {
+        epoch_position = 0;
+        return nullptr;
+    }
+    uint64_t n = consumed.load(memory_order_relaxed);
+    if (produced.load(memory_order_acquire) == n)
+    {
+        stalls++;
+        chrono::steady_clock::time_point stall_start = chrono::steady_clock::now();
+        while (produced.load(memory_order_acquire) == n)
+            this_thread::yield();
+        stall_ns += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - stall_start).count();
+    }
+    epoch_position++;
+    return &batches[n % slots];
+}
+
+void batch_loader::release()
+{
+    consumed.store(consumed.load(memory_order_relaxed) + 1, memory_order_release);
+}
+
+uint64_t batch_loader::get_batches_per_epoch() const
+{
+    return batches_per_epoch;
+}
+
+void batch_loader::print_statistics(ostream &out) const
+{
+    uint64_t trained = consumed.load();
+    out << "Batch loader: " << trained << " batches of " << batch_rows << " instances in a ring of " << slots << ", the trainer waited for " << stalls << " of them (" << stall_ns / 1e6 << " ms), the loader waited for a free buffer before " << full_waits << " of them\n";
+}
+
+void batch_loader::load()
+{
+    if (tracer::instance().enabled())
+        tracer::instance().set_thread_name("batch loader");
+    for (uint64_t n = 0;; n++)
+    {
+        // Waiting for the trainer to release the oldest buffer: by yielding for up to 200 us, which is shorter than the wake-up of a sleeping thread, and then by sleeping, so a full ring does not take the CPU of the trainer during long batches.
+        if (n - consumed.load(memory_order_acquire) >= slots)
+        {
+            full_waits++;
+            chrono::steady_clock::time_point wait_start = chrono::steady_clock::now();
+            while (n - consumed.load(memory_order_acquire) >= slots)
+            {
+                if (stopping)
+                    return;
+                if (chrono::steady_clock::now() - wait_start < chrono::microseconds(200))
+                    this_thread::yield();
+                else
+                    this_thread::sleep_for(chrono::microseconds(20));
+            }
+        }
+        if (stopping)
+            return;
+
+        // Shuffling the instances of the next epoch. The batches of the previous epoch were already gathered, so the order is not read by the trainer.
+        if (shuffle && n % batches_per_epoch == 0)
+        {
+            uint64_t epoch = first_epoch + n / batches_per_epoch;
+            copy(initial_order.begin(), initial_order.end(), order.begin());
+            for (uint64_t i = order.size() - 1; i > 0; i--)
+                swap(order[i], order[shuffle->bits(epoch * order.size() + i) % (i + 1)]);
+        }
+
+        // Gathering the rows of batch n into the buffer n % slots.
+        uint64_t slot = n % slots, first = n % batches_per_epoch * batch_rows, rows = min(batch_rows, order.size() - first);
+        double *batch_x = buffers + slot * stride;
+        uint64_t *batch_classes = &buffer_classes[slot * batch_rows];
+        for (uint64_t r = 0; r < rows; r++)
+        {
+            const vector<double> &row = (*x)[order[first + r]];
+            copy(row.begin(), row.end(), batch_x + r * columns);
+            batch_classes[r] = (*classes)[order[first + r]];
+        }
+        batches[slot] = {batch_x, batch_classes, rows};
+        produced.store(n + 1, memory_order_release);
+    }
+}
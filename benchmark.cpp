@@ -0,0 +1,627 @@
+/**
+ * @file benchmark.cpp
+ * @brief Benchmarks for the hot paths of the neural network.
+ *
+ * Measures CSV and binary dataset loading, network construction, forward and back propagation of a single instance, a full training iteration (single-threaded, multithreaded with the fast and the deterministic reduction with and without NUMA placement, and with matrix products with and without the batch loader) and inference over a batch with the network of edges and neurons and with fixed_network, for a grid of synthetic datasets and networks with one hidden layer. The forward, backward and weight-gradient matrix products of wide layers are measured in GFLOP/s and compared with the theoretical peak of the cores of the thread pool, and the cost of a range of the thread pool is measured. The results are written as JSON and could be compared with a saved baseline.
+ *
+ * Usage: benchmark [--features 13,32] [--widths 5,16] [--rows 160,1000] [--classes 3] [--threads 4] [--gemm-widths 256,1024,2048] [--gemm-rows 256] [--peak gflops] [--pool n] [--min-time 0.2] [--output results.json] [--baseline baseline.json] [--threshold 10]
+ *
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include "profiler.hpp"
+#include "trace.hpp"
+#include "activation.hpp"
+#include "thread_pool.hpp"
+#include "counter_rng.hpp"
+#include "edge.hpp"
+#include "neuron.hpp"
+#include "layer.hpp"
+#include "transport.hpp"
+#include "reduction.hpp"
+#include "network.hpp"
+#include "gemm.hpp"
+#include "numa.hpp"
+#include "gradient_accumulator.hpp"
+#include "batch_loader.hpp"
+#include "gemm_accumulator.hpp"
+#include "standardization.hpp"
+#include "read_x.hpp"
+#include "read_y.hpp"
+#include "binary_dataset.hpp"
+#include "model.hpp"
+#include "fixed_network.hpp"
+
+using namespace std;
+
+/**
+ * @brief The result of one benchmark for one point of the grid.
+ *
+ */
+struct benchmark_result
+{
+     string name;              // Name of the benchmark.
+     uint64_t features = 0;    // Number of features of the dataset.
+     uint64_t width = 0;       // Number of neurons of the hidden layer.
+     uint64_t rows = 0;        // Number of rows of the dataset.
+     uint64_t repetitions = 0; // Number of timed runs of the operation.
+     double ns_per_op = 0;     // Average time of one operation in nanoseconds.
+     double items_per_op = 0;  // Number of items (rows, bytes or floating point operations) processed by one operation.
+     string item = "rows";     // The kind of items processed by one operation.
+};
+
+/**
+ * @brief Splitting a comma separated list of integer numbers.
+ *
+ * @param s The list.
+ * @return vector<uint64_t> The numbers.
+ */
+vector<uint64_t> parse_list(const string &s)
+{
+     vector<uint64_t> values;
+     string value;
+     istringstream string_stream(s);
+     while (getline(string_stream, value, ','))
+          values.push_back(stoull(value));
+     return values;
+}
+
+/**
+ * @brief Running an operation repeatedly until the minimum time has passed, after one warm-up run.
+ *
+ * @tparam F Type of the operation.
+ * @param f The operation.
+ * @param min_time Minimum total time in seconds.
+ * @param repetitions Number of timed runs.
+ * @return double Average time of one run in nanoseconds.
+ */
+template <typename F>
+double time_per_op(F f, const double &min_time, uint64_t &repetitions)
+{
+     f();
+     repetitions = 0;
+     double elapsed = 0;
+     chrono::steady_clock::time_point start = chrono::steady_clock::now();
+     do
+     {
+          f();
+          repetitions++;
+          elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+     } while (elapsed < min_time);
+     return elapsed * 1e9 / (double)repetitions;
+}
+
+/**
+ * @brief Timing the inference of fixed_network over all the rows if its architecture is the same as the model, since the sizes of a fixed network are template arguments. The default grid is compiled in.
+ *
+ * @tparam Features Number of features.
+ * @tparam Width Number of neurons of the hidden layer.
+ * @tparam Classes Number of classes.
+ * @param m The model of the network.
+ * @param x Features of the rows, with the bias unit as the first column.
+ * @param predicted The predicted class of each row.
+ * @param min_time Minimum total time in seconds.
+ * @param r The result, whose time and repetitions are set.
+ * @return true If the architecture of the model is the same as the fixed network.
+ * @return false Otherwise.
+ */
+template <uint64_t Features, uint64_t Width, uint64_t Classes>
+bool time_fixed_network(const model &m, const vector<vector<double>> &x, vector<int64_t> &predicted, const double &min_time, benchmark_result &r)
+{
+     if (m.get_number_nodes() != vector<uint64_t>{Features, Width, Classes})
+          return false;
+     fixed_network<Features, Width, Classes> f(m);
+     r.ns_per_op = time_per_op([&]()
+                               {
+                                    for (uint64_t t = 0; t < x.size(); t++)
+                                         predicted[t] = f.predict(&x[t][1]); },
+                               min_time, r.repetitions);
+     return true;
+}
+
+/**
+ * @brief Estimating the theoretical peak of one core in GFLOP/s from the clock frequency in /proc/cpuinfo and the double precision operations per cycle of the vector instructions the benchmark was compiled for, assuming two vector units (With fused multiply-add if it is enabled).
+ *
+ * @return double The peak in GFLOP/s (0 if the frequency is unknown).
+ */
+double estimate_peak_gflops()
+{
+     double flops_per_cycle = 4; // Two SSE2 units of 2 doubles.
+#if defined(__AVX512F__)
+     flops_per_cycle = 32;
+#elif defined(__FMA__)
+     flops_per_cycle = 16;
+#elif defined(__AVX__)
+     flops_per_cycle = 8;
+#endif
+     ifstream input("/proc/cpuinfo");
+     string s;
+     while (getline(input, s))
+     {
+          if (s.rfind("cpu MHz", 0) == 0 && s.find(':') != string::npos)
+               return stod(s.substr(s.find(':') + 1)) * 1e-3 * flops_per_cycle;
+     }
+     return 0;
+}
+
+/**
+ * @brief Finding the value of a key in a line of the JSON written by write_json().
+ *
+ * @param line A line of the JSON file.
+ * @param key The key.
+ * @return string The value of the key without quotes (Empty if the key is not in the line).
+ */
+string json_value(const string &line, const string &key)
+{
+     size_t position = line.find("\"" + key + "\":");
+     if (position == string::npos)
+          return "";
+     position += key.size() + 3;
+     while (position < line.size() && (line[position] == ' ' || line[position] == '"'))
+          position++;
+     size_t end = line.find_first_of(",\"}", position);
+     return line.substr(position, end - position);
+}
+
+/**
+ * @brief Writing the results as JSON with one benchmark per line.
+ *
+ * @param out Output stream.
+ * @param results The results of the benchmarks.
+ */
+void write_json(ostream &out, const vector<benchmark_result> &results)
+{
+     out << "{\n  \"benchmarks\": [\n";
+     for (uint64_t i = 0; i < results.size(); i++)
+     {
+          const benchmark_result &r = results[i];
+          out << "    {\"name\": \"" << r.name << "\", \"features\": " << r.features << ", \"width\": " << r.width << ", \"rows\": " << r.rows
+              << ", \"repetitions\": " << r.repetitions << ", \"ns_per_op\": " << r.ns_per_op
+              << ", \"" << r.item << "_per_second\": " << r.items_per_op * 1e9 / r.ns_per_op << "}" << (i + 1 < results.size() ? "," : "") << '\n';
+     }
+     out << "  ]\n}\n";
+}
+
+/**
+ * @brief Reading the results saved by write_json().
+ *
+ * @param filename The JSON file.
+ * @return vector<benchmark_result> The saved results.
+ */
+vector<benchmark_result> read_json(const string &filename)
+{
+     ifstream input(filename);
+     if (!input.is_open())
+     {
+          cout << "Error opening " << filename << " input file!";
+          throw invalid_argument("");
+     }
+     vector<benchmark_result> results;
+     string s;
+     while (getline(input, s))
+     {
+          if (json_value(s, "name").empty())
+               continue;
+          benchmark_result r;
+          r.name = json_value(s, "name");
+          r.features = stoull(json_value(s, "features"));
+          r.width = stoull(json_value(s, "width"));
+          r.rows = stoull(json_value(s, "rows"));
+          r.repetitions = stoull(json_value(s, "repetitions"));
+          r.ns_per_op = stod(json_value(s, "ns_per_op"));
+          results.push_back(r);
+     }
+     return results;
+}
+
+int main(int argc, char *argv[])
+{
+     try
+     {
+          // Reading the command line options.
+          vector<uint64_t> features_grid = {13, 32};
+          vector<uint64_t> widths_grid = {5, 16};
+          vector<uint64_t> rows_grid = {160, 1000};
+          uint64_t number_classes = 3;
+          uint64_t number_threads = max<uint64_t>(thread::hardware_concurrency(), 1); // Threads of the multithreaded training iterations.
+          vector<uint64_t> gemm_widths_grid = {256, 1024, 2048}; // Widths of the layers of the matrix products.
+          uint64_t gemm_rows = 256;                               // Number of instances of a block of the matrix products.
+          double peak_gflops = 0;                                 // Theoretical peak of one core (Estimated if zero).
+          uint64_t pool_threads = 0;                              // Number of threads of the thread pool (One per CPU if zero).
+          double min_time = 0.2;
+          double threshold = 10; // Percentage of slowdown compared to the baseline which is reported as a regression.
+          string output_filename, baseline_filename;
+          for (int i = 1; i < argc; i++)
+          {
+               string option = argv[i];
+               if (i + 1 >= argc)
+                    option = "";
+               if (option == "--features")
+                    features_grid = parse_list(argv[++i]);
+               else if (option == "--widths")
+                    widths_grid = parse_list(argv[++i]);
+               else if (option == "--rows")
+                    rows_grid = parse_list(argv[++i]);
+               else if (option == "--classes")
+                    number_classes = stoull(argv[++i]);
+               else if (option == "--threads")
+                    number_threads = max<uint64_t>(stoull(argv[++i]), 1);
+               else if (option == "--gemm-widths")
+                    gemm_widths_grid = parse_list(argv[++i]);
+               else if (option == "--gemm-rows")
+                    gemm_rows = max<uint64_t>(stoull(argv[++i]), 1);
+               else if (option == "--peak")
+                    peak_gflops = stod(argv[++i]);
+               else if (option == "--pool")
+                    pool_threads = max<uint64_t>(stoull(argv[++i]), 1);
+               else if (option == "--min-time")
+                    min_time = stod(argv[++i]);
+               else if (option == "--output")
+                    output_filename = argv[++i];
+               else if (option == "--baseline")
+                    baseline_filename = argv[++i];
+               else if (option == "--threshold")
+                    threshold = stod(argv[++i]);
+               else
+               {
+                    cout << "Usage: " << argv[0] << " [--features 13,32] [--widths 5,16] [--rows 160,1000] [--classes 3] [--threads 4] [--gemm-widths 256,1024,2048] [--gemm-rows 256] [--peak gflops] [--pool n] [--min-time 0.2] [--output results.json] [--baseline baseline.json] [--threshold 10]\n";
+                    return -1;
+               }
+          }
+
+          if (pool_threads > 0)
+               thread_pool::instance().resize(pool_threads);
+          mt19937 mt(0);
+          normal_distribution<double> nd(0, 1);
+          vector<benchmark_result> results;
+
+          for (const uint64_t &number_features : features_grid)
+          {
+               for (const uint64_t &number_rows : rows_grid)
+               {
+                    // Creating a synthetic dataset. The first element of each row is the bias unit, as in read_x.
+                    vector<vector<double>> x(number_rows, vector<double>(number_features + 1, 1));
+                    vector<uint64_t> classes(number_rows);
+                    for (uint64_t i = 0; i < number_rows; i++)
+                    {
+                         classes[i] = i % number_classes + 1;
+                         for (uint64_t j = 1; j <= number_features; j++)
+                              x[i][j] = nd(mt) + (double)classes[i];
+                    }
+
+                    // CSV loading, which does not depend on the network.
+                    {
+                         string x_filename = "benchmark_x.csv", y_filename = "benchmark_y.csv";
+                         ofstream x_output(x_filename), y_output(y_filename);
+                         for (uint64_t i = 0; i < number_rows; i++)
+                         {
+                              for (uint64_t j = 1; j <= number_features; j++)
+                                   x_output << x[i][j] << (j < number_features ? ',' : '\n');
+                              y_output << classes[i] << '\n';
+                         }
+                         x_output.close();
+                         y_output.close();
+                         ifstream x_input(x_filename, ios::ate), y_input(y_filename, ios::ate);
+                         double bytes = (double)x_input.tellg() + (double)y_input.tellg();
+
+                         benchmark_result r{"csv_load", number_features, 0, number_rows};
+                         streambuf *cout_buffer = cout.rdbuf(nullptr); // The readers print a message for each file.
+                         r.ns_per_op = time_per_op([&]()
+                                                   {
+                                                        read_x xr(x_filename);
+                                                        read_y yr(y_filename); },
+                                                   min_time, r.repetitions);
+                         cout.rdbuf(cout_buffer);
+                         r.items_per_op = bytes;
+                         r.item = "bytes";
+                         results.push_back(r);
+                         remove(x_filename.c_str());
+                         remove(y_filename.c_str());
+                    }
+
+                    // Binary dataset loading, which skips parsing the text.
+                    {
+                         string binary_filename = "benchmark.bin";
+                         write_binary output(binary_filename, number_features);
+                         for (uint64_t i = 0; i < number_rows; i++)
+                              output.write_row(&x[i][1], classes[i]);
+                         output.close();
+                         ifstream input(binary_filename, ios::ate);
+                         double bytes = (double)input.tellg();
+
+                         benchmark_result r{"binary_load", number_features, 0, number_rows};
+                         r.ns_per_op = time_per_op([&]()
+                                                   { read_binary b(binary_filename); },
+                                                   min_time, r.repetitions);
+                         r.items_per_op = bytes;
+                         r.item = "bytes";
+                         results.push_back(r);
+                         remove(binary_filename.c_str());
+                    }
+
+                    for (const uint64_t &width : widths_grid)
+                    {
+                         vector<uint64_t> number_nodes = {number_features, width, number_classes};
+                         vector<activation_type> activation_functions(number_nodes.size() - 1, activation_type::sigmoid);
+
+                         // Construction, forward and back propagation do not depend on the number of rows.
+                         if (number_rows == rows_grid[0])
+                         {
+                              benchmark_result r{"construction", number_features, width, 0};
+                              r.ns_per_op = time_per_op([&]()
+                                                        {
+                                                             vector<layer> layers;
+                                                             vector<neuron> neurons;
+                                                             vector<edge> edges;
+                                                             generate_network(number_nodes, activation_functions, layers, neurons, edges); },
+                                                        min_time, r.repetitions);
+                              r.items_per_op = 1;
+                              r.item = "networks";
+                              results.push_back(r);
+                         }
+
+                         vector<layer> layers;
+                         vector<neuron> neurons;
+                         vector<edge> edges;
+                         network N = generate_network(number_nodes, activation_functions, layers, neurons, edges);
+
+                         if (number_rows == rows_grid[0])
+                         {
+                              uint64_t t = 0;
+                              benchmark_result r{"forward", number_features, width, 0};
+                              r.ns_per_op = time_per_op([&]()
+                                                        {
+                                                             N.forward_propagation(layers, neurons, edges, x[t]);
+                                                             t = (t + 1) % number_rows; },
+                                                        min_time, r.repetitions);
+                              r.items_per_op = 1;
+                              results.push_back(r);
+
+                              r = {"backward", number_features, width, 0};
+                              r.ns_per_op = time_per_op([&]()
+                                                        { N.back_propagation(layers, neurons, edges, classes[t]); },
+                                                        min_time, r.repetitions);
+                              r.items_per_op = 1;
+                              results.push_back(r);
+                         }
+
+                         // One iteration of training over all the rows.
+                         benchmark_result r{"train_iteration", number_features, width, number_rows};
+                         r.ns_per_op = time_per_op([&]()
+                                                   {
+                                                        for (edge &i : edges)
+                                                             i.set_delta_zero();
+                                                        for (uint64_t t = 0; t < number_rows; t++)
+                                                        {
+                                                             N.forward_propagation(layers, neurons, edges, x[t]);
+                                                             N.back_propagation(layers, neurons, edges, classes[t]);
+                                                        }
+                                                        N.gradient_update(edges, number_rows, 0.01);
+                                                        N.gradient_descent(edges, 0.06); },
+                                                   min_time, r.repetitions);
+                         r.items_per_op = (double)number_rows;
+                         results.push_back(r);
+
+                         // The same iteration with the deltas computed by several threads, for the cost of the deterministic reduction compared with the fast one, and for the speedup of pinning the threads and placing their data on their NUMA nodes.
+                         numa_topology topology;
+                         for (const reduction_mode &mode : {reduction_mode::fast, reduction_mode::deterministic})
+                         {
+                              for (const bool &placement : {false, true})
+                              {
+                                   gradient_accumulator accumulator(layers, neurons, edges, number_threads, mode, placement ? &topology : nullptr);
+                                   r = {string(mode == reduction_mode::fast ? "train_iteration_fast" : "train_iteration_deterministic") + (placement ? "_numa" : ""), number_features, width, number_rows};
+                                   r.ns_per_op = time_per_op([&]()
+                                                             {
+                                                                  accumulator.accumulate(N, edges, x, classes, 0, number_rows);
+                                                                  N.gradient_update(edges, number_rows, 0.01);
+                                                                  N.gradient_descent(edges, 0.06); },
+                                                             min_time, r.repetitions);
+                                   r.items_per_op = (double)number_rows;
+                                   results.push_back(r);
+                              }
+                         }
+
+                         // The same iteration with the deltas computed by matrix products over blocks of instances.
+                         {
+                              gemm_accumulator accumulator(layers, neurons);
+                              r = {"train_iteration_gemm", number_features, width, number_rows};
+                              r.ns_per_op = time_per_op([&]()
+                                                        {
+                                                             accumulator.accumulate(N, edges, x, classes, 0, number_rows);
+                                                             N.gradient_update(edges, number_rows, 0.01);
+                                                             N.gradient_descent(edges, 0.06); },
+                                                        min_time, r.repetitions);
+                              r.items_per_op = (double)number_rows;
+                              results.push_back(r);
+
+                              // The blocks of a shuffled order of the rows gathered in the background by the batch loader.
+                              vector<uint64_t> shuffled_order(number_rows);
+                              iota(shuffled_order.begin(), shuffled_order.end(), 0);
+                              shuffle(shuffled_order.begin(), shuffled_order.end(), mt);
+                              batch_loader loader(x, classes, shuffled_order, accumulator.get_block_rows());
+                              r = {"train_iteration_gemm_prefetch", number_features, width, number_rows};
+                              r.ns_per_op = time_per_op([&]()
+                                                        {
+                                                             accumulator.accumulate(N, edges, loader);
+                                                             N.gradient_update(edges, number_rows, 0.01);
+                                                             N.gradient_descent(edges, 0.06); },
+                                                        min_time, r.repetitions);
+                              r.items_per_op = (double)number_rows;
+                              results.push_back(r);
+                         }
+
+                         // Inference over all the rows.
+                         vector<uint64_t> predicted_classes(number_rows);
+                         r = {"inference", number_features, width, number_rows};
+                         r.ns_per_op = time_per_op([&]()
+                                                   {
+                                                        for (uint64_t t = 0; t < number_rows; t++)
+                                                        {
+                                                             N.forward_propagation(layers, neurons, edges, x[t]);
+                                                             predicted_classes[t] = N.predict_class(neurons, number_nodes.size(), number_classes);
+                                                        } },
+                                                   min_time, r.repetitions);
+                         r.items_per_op = (double)number_rows;
+                         results.push_back(r);
+
+                         // Inference over all the rows with fixed_network, for the architectures of the default grid.
+                         model m(number_nodes, activation_functions, edges);
+                         vector<int64_t> fixed_classes(number_rows);
+                         r = {"inference_fixed", number_features, width, number_rows};
+                         if (time_fixed_network<13, 5, 3>(m, x, fixed_classes, min_time, r) || time_fixed_network<13, 16, 3>(m, x, fixed_classes, min_time, r) ||
+                             time_fixed_network<32, 5, 3>(m, x, fixed_classes, min_time, r) || time_fixed_network<32, 16, 3>(m, x, fixed_classes, min_time, r))
+                         {
+                              r.items_per_op = (double)number_rows;
+                              results.push_back(r);
+                         }
+                    }
+               }
+          }
+
+          // The matrix products of a layer of width inputs and outputs for a block of instances: the weighted sums (A theta^T), the errors of the previous layer (E theta) and the deltas (E^T A), and the weighted sums with a plain loop over the contiguous weights for comparison.
+          if (peak_gflops == 0)
+               peak_gflops = estimate_peak_gflops();
+          for (const uint64_t &width : gemm_widths_grid)
+          {
+               uint64_t inputs = width + 1; // With the bias unit.
+               vector<double> a(gemm_rows * inputs), theta(width * inputs), z(gemm_rows * width), e(gemm_rows * width), delta(width * inputs);
+               for (double &i : a)
+                    i = nd(mt);
+               for (double &i : theta)
+                    i = nd(mt) / sqrt((double)inputs);
+               for (double &i : e)
+                    i = nd(mt);
+               vector<double> packing(max({gemm_workspace_size(gemm_rows, width, inputs), gemm_workspace_size(gemm_rows, width, width), gemm_workspace_size(width, inputs, gemm_rows)}));
+               double flops = 2.0 * (double)gemm_rows * (double)width * (double)inputs;
+
+               benchmark_result r{"gemm_forward", width, width, gemm_rows};
+               r.ns_per_op = time_per_op([&]()
+                                         { gemm(false, true, gemm_rows, width, inputs, a.data(), inputs, theta.data(), inputs, 0, z.data(), width, packing.data()); },
+                                         min_time, r.repetitions);
+               r.items_per_op = flops;
+               r.item = "flops";
+               results.push_back(r);
+
+               r = {"naive_forward", width, width, gemm_rows};
+               r.ns_per_op = time_per_op([&]()
+                                         {
+                                              for (uint64_t j = 0; j < width; j++)
+                                                   for (uint64_t t = 0; t < gemm_rows; t++)
+                                                   {
+                                                        double sum = 0;
+                                                        for (uint64_t k = 0; k < inputs; k++)
+                                                             sum += theta[j * inputs + k] * a[t * inputs + k];
+                                                        z[t * width + j] = sum;
+                                                   } },
+                                         min_time, r.repetitions);
+               r.items_per_op = flops;
+               r.item = "flops";
+               results.push_back(r);
+
+               r = {"gemm_backward", width, width, gemm_rows};
+               r.ns_per_op = time_per_op([&]()
+                                         { gemm(false, false, gemm_rows, width, width, e.data(), width, theta.data() + 1, inputs, 0, z.data(), width, packing.data()); },
+                                         min_time, r.repetitions);
+               r.items_per_op = 2.0 * (double)gemm_rows * (double)width * (double)width;
+               r.item = "flops";
+               results.push_back(r);
+
+               r = {"gemm_gradient", width, width, gemm_rows};
+               r.ns_per_op = time_per_op([&]()
+                                         { gemm(true, false, width, inputs, gemm_rows, e.data(), width, a.data(), inputs, 1, delta.data(), inputs, packing.data()); },
+                                         min_time, r.repetitions);
+               r.items_per_op = flops;
+               r.item = "flops";
+               results.push_back(r);
+          }
+
+          // Cost of a parallel_for() of the thread pool per range, with ranges which do almost nothing.
+          {
+               vector<uint64_t> counts(1024);
+               benchmark_result r{"thread_pool_for", 0, 0, counts.size()};
+               r.ns_per_op = time_per_op([&]()
+                                         { thread_pool::instance().parallel_for(0, counts.size(), 1, [&](const uint64_t &begin, const uint64_t &end)
+                                                                                 {
+                                                                                      for (uint64_t i = begin; i < end; i++)
+                                                                                           counts[i]++;
+                                                                                 }); },
+                                         min_time, r.repetitions);
+               r.items_per_op = counts.size();
+               r.item = "ranges";
+               results.push_back(r);
+          }
+
+          // Printing a summary and comparing with the baseline.
+          vector<benchmark_result> baseline;
+          if (!baseline_filename.empty())
+               baseline = read_json(baseline_filename);
+          uint64_t regressions = 0;
+          cerr << "\nname\tfeatures\twidth\trows\tns_per_op\tbaseline\tchange(%)\n";
+          for (const benchmark_result &r : results)
+          {
+               cerr << r.name << '\t' << r.features << '\t' << r.width << '\t' << r.rows << '\t' << r.ns_per_op;
+               for (const benchmark_result &b : baseline)
+               {
+                    if (b.name == r.name && b.features == r.features && b.width == r.width && b.rows == r.rows)
+                    {
+                         double change = 100 * (r.ns_per_op - b.ns_per_op) / b.ns_per_op;
+                         cerr << '\t' << b.ns_per_op << '\t' << change;
+                         if (change > threshold)
+                         {
+                              cerr << "\tREGRESSION";
+                              regressions++;
+                         }
+                    }
+               }
+               cerr << '\n';
+          }
+
+          cerr << "\nname\twidth\trows\tGFLOP/s\tpeak(%)\n";
+          for (const benchmark_result &r : results)
+          {
+               if (r.item != "flops")
+                    continue;
+               double gflops = r.items_per_op / r.ns_per_op;
+               cerr << r.name << '\t' << r.width << '\t' << r.rows << '\t' << gflops << '\t';
+               if (peak_gflops > 0)
+                    cerr << 100 * gflops / (peak_gflops * thread_pool::instance().get_threads());
+               else
+                    cerr << '-';
+               cerr << '\n';
+          }
+          if (peak_gflops > 0)
+               cerr << "Theoretical peak of one core: " << peak_gflops << " GFLOP/s (The products use the " << thread_pool::instance().get_threads() << " threads of the thread pool)\n";
+          thread_pool::instance().print_statistics(cerr);
+
+          if (output_filename.empty())
+               write_json(cout, results);
+          else
+          {
+               ofstream output(output_filename);
+               write_json(output, results);
+          }
+
+          if (regressions > 0)
+          {
+               cerr << '\n'
+                    << regressions << " benchmarks are more than " << threshold << "% slower than the baseline!\n";
+               return 1;
+          }
+     }
+     catch (const exception &e)
+     {
+          cerr << e.what() << '\n';
+          return -1;
+     }
+}
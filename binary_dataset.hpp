@@ -0,0 +1,278 @@
+#include <iostream>
+#include <stdexcept>
+#include <fstream>
+#include <vector>
+#include <cstring>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief Binary form of a dataset which could be loaded without parsing text. The file starts with the characters "NNBD", the version (uint64_t), the number of rows (uint64_t) and the number of features (uint64_t). Then each row is stored as its class (uint64_t) followed by the feature values (double).
+ *
+ */
+class write_binary
+{
+
+public:
+    /**
+    * @brief Construct a new write binary::write binary object which creates the file and writes the header. The number of rows is written when the file is closed.
+    *
+    * @param filename The file name for saving the dataset.
+    * @param _columns Number of features of the dataset.
+    */
+    write_binary(const string &, const uint64_t &);
+
+    /**
+    * @brief Destroy the write binary::write binary object and close the file.
+    *
+    */
+    ~write_binary();
+
+    /**
+    * @brief Member function to write one row of the dataset.
+    *
+    * @param features The feature values of the row (Without the bias unit).
+    * @param category The class of the row.
+    */
+    void write_row(const double *, const uint64_t &);
+
+    /**
+    * @brief Member function to write the number of rows to the header and close the file.
+    *
+    */
+    void close();
+
+    /**
+     * @brief Error if there is a problem with the file.
+     *
+     */
+    class invalid_file : public invalid_argument
+    {
+    public:
+        invalid_file() : invalid_argument(""){};
+    };
+
+private:
+    /**
+     * @brief The output file.
+     *
+     */
+    ofstream output;
+
+    /**
+     * @brief Number of rows written so far.
+     *
+     */
+    uint64_t rows = 0;
+
+    /**
+     * @brief Number of features of the dataset.
+     *
+     */
+    uint64_t columns = 0;
+};
+
+class read_binary
+{
+
+public:
+    /**
+    * @brief Construct a new read binary::read binary object which reads a dataset saved by write_binary.
+    *
+    * @param filename The file name that contains the dataset.
+    */
+    read_binary(const string &);
+
+    /**
+    * @brief Member function to obtain (but not modify) the feature values. As in read_x, the first element of each row is 1 for the bias unit.
+    *
+    * @return const vector<vector<double>>& Values of the features dataset.
+    */
+    const vector<vector<double>> &get_values() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the classes of the rows.
+    *
+    * @return const vector<uint64_t>& Classes of the dataset.
+    */
+    const vector<uint64_t> &get_classes() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of instances of the dataset.
+    *
+    * @return uint64_t Number of rows (instances) of the dataset.
+    */
+    uint64_t get_rows() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of features of the dataset.
+    *
+    * @return uint64_t Number of columns (features) of the dataset.
+    */
+    uint64_t get_cols() const;
+
+    /**
+     * @brief Error if the file does not start with the header of write_binary.
+     *
+     */
+    class not_binary_dataset : public invalid_argument
+    {
+    public:
+        not_binary_dataset() : invalid_argument("The file is not a binary dataset!"){};
+    };
+
+    /**
+     * @brief Error if the file is shorter than the rows given in the header.
+     *
+     */
+    class truncated_file : public length_error
+    {
+    public:
+        truncated_file() : length_error("The file has less rows than its header!"){};
+    };
+
+    /**
+     * @brief Error if there is a problem with the file.
+     *
+     */
+    class invalid_file : public invalid_argument
+    {
+    public:
+        invalid_file() : invalid_argument(""){};
+    };
+
+private:
+    /**
+     * @brief The number of rows of the dataset.
+     *
+     */
+    uint64_t rows = 0;
+
+    /**
+     * @brief The number of features of the dataset.
+     *
+     */
+    uint64_t columns = 0;
+
+    /**
+     * @brief A vector containing the feature values of the dataset.
+     *
+     */
+    vector<vector<double>> values;
+
+    /**
+     * @brief A vector containing the classes of the dataset.
+     *
+     */
+    vector<uint64_t> classes;
+};
+
+/**
+ * @brief The first characters of a binary dataset file.
+ *
+ */
+constexpr char binary_dataset_magic[4] = {'N', 'N', 'B', 'D'};
+
+/**
+ * @brief The version of the binary dataset format.
+ *
+ */
+constexpr uint64_t binary_dataset_version = 1;
+
+// ==============
+// Implementation
+// ==============
+
+write_binary::write_binary(const string &filename, const uint64_t &_columns)
+    : output(filename, ios::binary), columns(_columns)
+{
+    if (!output.is_open())
+    {
+        cout << "Error opening " << filename << " output file!";
+        throw invalid_file();
+    }
+    output.write(binary_dataset_magic, sizeof(binary_dataset_magic));
+    output.write(reinterpret_cast<const char *>(&binary_dataset_version), sizeof(uint64_t));
+    output.write(reinterpret_cast<const char *>(&rows), sizeof(uint64_t));
+    output.write(reinterpret_cast<const char *>(&columns), sizeof(uint64_t));
+}
+
+write_binary::~write_binary()
+{
+    if (output.is_open())
+        close();
+}
+
+void write_binary::write_row(const double *features, const uint64_t &category)
+{
+    output.write(reinterpret_cast<const char *>(&category), sizeof(uint64_t));
+    output.write(reinterpret_cast<const char *>(features), columns * sizeof(double));
+    rows++;
+}
+
+void write_binary::close()
+{
+    output.seekp(sizeof(binary_dataset_magic) + sizeof(uint64_t));
+    output.write(reinterpret_cast<const char *>(&rows), sizeof(uint64_t));
+    output.close();
+}
+
+read_binary::read_binary(const string &filename)
+{
+    ifstream input(filename, ios::binary);
+    if (!input.is_open())
+    {
+        cout << "Error opening " << filename << " input file!";
+        throw invalid_file();
+    }
+    try
+    {
+        char magic[sizeof(binary_dataset_magic)];
+        uint64_t version = 0;
+        input.read(magic, sizeof(magic));
+        input.read(reinterpret_cast<char *>(&version), sizeof(uint64_t));
+        input.read(reinterpret_cast<char *>(&rows), sizeof(uint64_t));
+        input.read(reinterpret_cast<char *>(&columns), sizeof(uint64_t));
+        if (!input || memcmp(magic, binary_dataset_magic, sizeof(magic)) != 0 || version != binary_dataset_version)
+            throw not_binary_dataset();
+
+        values = vector<vector<double>>(rows, vector<double>(columns + 1, 1));
+        classes = vector<uint64_t>(rows);
+        for (uint64_t i = 0; i < rows; i++)
+        {
+            input.read(reinterpret_cast<char *>(&classes[i]), sizeof(uint64_t));
+            input.read(reinterpret_cast<char *>(&values[i][1]), columns * sizeof(double));
+        }
+        if (!input)
+            throw truncated_file();
+    }
+    catch (const exception &e)
+    {
+        cout << "Error in " << filename << ": " << e.what() << '\n';
+        throw invalid_file();
+    }
+    input.close();
+}
+
+const vector<vector<double>> &read_binary::get_values() const
+{
+    return values;
+}
+
+const vector<uint64_t> &read_binary::get_classes() const
+{
+    return classes;
+}
+
+uint64_t read_binary::get_rows() const
+{
+    return rows;
+}
+
+uint64_t read_binary::get_cols() const
+{
+    return columns;
+}
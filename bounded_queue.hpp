@@ -0,0 +1,133 @@
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief Queue with a maximum number of items which connects the stages of a pipeline. A producer waits while the queue is full, so a fast stage could not run ahead of a slow one and fill the memory.
+ *
+ * @tparam T Type of the items.
+ */
+template <typename T>
+class bounded_queue
+{
+
+public:
+    /**
+    * @brief Construct a new bounded queue::bounded queue object.
+    *
+    * @param _capacity Maximum number of items in the queue.
+    */
+    bounded_queue(const uint64_t &);
+
+    /**
+    * @brief Member function to add an item, waiting while the queue is full.
+    *
+    * @param item The item.
+    * @return true If the item was added.
+    * @return false If the queue was closed.
+    */
+    bool push(const T &);
+
+    /**
+    * @brief Member function to remove the oldest item, waiting while the queue is empty.
+    *
+    * @param item The removed item.
+    * @return true If an item was removed.
+    * @return false If the queue is closed and empty.
+    */
+    bool pop(T &);
+
+    /**
+    * @brief Member function to close the queue. The remaining items could still be removed, and the waiting threads are woken up.
+    *
+    */
+    void close();
+
+private:
+    /**
+     * @brief Maximum number of items in the queue.
+     *
+     */
+    uint64_t capacity = 1;
+
+    /**
+     * @brief If the queue is closed.
+     *
+     */
+    bool closed = false;
+
+    /**
+     * @brief The items in order of arrival.
+     *
+     */
+    deque<T> items;
+
+    /**
+     * @brief Mutex for the items.
+     *
+     */
+    mutex items_mutex;
+
+    /**
+     * @brief Notified when an item is added or the queue is closed.
+     *
+     */
+    condition_variable not_empty;
+
+    /**
+     * @brief Notified when an item is removed or the queue is closed.
+     *
+     */
+    condition_variable not_full;
+};
+
+// ==============
+// Implementation
+// ==============
+
+template <typename T>
+bounded_queue<T>::bounded_queue(const uint64_t &_capacity)
+    : capacity(_capacity)
+{
+}
+
+template <typename T>
+bool bounded_queue<T>::push(const T &item)
+{
+    unique_lock<mutex> lock(items_mutex);
+    not_full.wait(lock, [&]()
+                  { return items.size() < capacity || closed; });
+    if (closed)
+        return false;
+    items.push_back(item);
+    not_empty.notify_one();
+    return true;
+}
+
+template <typename T>
+bool bounded_queue<T>::pop(T &item)
+{
+    unique_lock<mutex> lock(items_mutex);
+    not_empty.wait(lock, [&]()
+                   { return !items.empty() || closed; });
+    if (items.empty())
+        return false;
+    item = items.front();
+    items.pop_front();
+    not_full.notify_one();
+    return true;
+}
+
+template <typename T>
+void bounded_queue<T>::close()
+{
+    lock_guard<mutex> lock(items_mutex);
+    closed = true;
+    not_empty.notify_all();
+    not_full.notify_all();
+}
@@ -0,0 +1,432 @@
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <array>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief The state of a run which is saved in a checkpoint. If the iteration is zero, the fold has not started yet, so only the accuracies and the best accuracy are used.
+ *
+ */
+struct checkpoint_state
+{
+    uint64_t sequence = 0;     // Number of the checkpoint, which increases with every checkpoint of a run.
+    uint64_t fold = 0;         // The fold of the cross validation (Starting from 0).
+    uint64_t iteration = 0;    // Number of training iterations of the fold which were done.
+    uint64_t seed = 0;         // Seed of the random numbers of the run.
+    double best_accuracy = -1; // Best accuracy of the finished folds (-1 if no fold has finished).
+    vector<double> accuracies; // Accuracy of each finished fold.
+    vector<double> weights;    // Weight of each edge.
+    vector<double> gradients;  // Gradient of each edge (The state of gradient descent).
+};
+
+/**
+ * @brief Writer of checkpoints in a background thread, so the training loop never waits for the disk. There are two snapshots: the training loop fills one while the thread writes the other. If a snapshot is waiting when a new checkpoint is submitted, it is replaced by the newer one. The checkpoints are written alternately to checkpoint.0 and checkpoint.1 in a directory through a temporary file which is renamed when it is complete, so a crash leaves at least one valid checkpoint.
+ *
+ */
+class checkpoint_writer
+{
+
+public:
+    /**
+    * @brief Construct a new checkpoint writer::checkpoint writer object and start its thread. The snapshots are allocated here, so submitting a checkpoint does not allocate.
+    *
+    * @param _directory Directory of the checkpoints, which is created if it does not exist.
+    * @param number_edges Number of edges of the network.
+    * @param number_folds Number of folds of the cross validation.
+    * @param first_sequence Number of the first checkpoint (After the checkpoint of a resumed run).
+    */
+    checkpoint_writer(const string &, const uint64_t &, const uint64_t &, const uint64_t & = 1);
+
+    /**
+    * @brief Destroy the checkpoint writer::checkpoint writer object after the waiting snapshot is written.
+    *
+    */
+    ~checkpoint_writer();
+
+    checkpoint_writer(const checkpoint_writer &) = delete;
+    checkpoint_writer &operator=(const checkpoint_writer &) = delete;
+
+    /**
+    * @brief Member function to copy the state of the run into a snapshot for the thread to write.
+    *
+    * @param fold The fold of the cross validation.
+    * @param iteration Number of training iterations of the fold which were done.
+    * @param seed Seed of the random numbers of the run.
+    * @param accuracies Accuracy of each finished fold (Only the first fold elements are saved).
+    * @param best_accuracy Best accuracy of the finished folds.
+    * @param edges A vector containing all the edges of the network.
+    */
+    void submit(const uint64_t &, const uint64_t &, const uint64_t &, const vector<double> &, const double &, const vector<edge> &);
+
+    /**
+    * @brief Member function to wait until the submitted checkpoints are written.
+    *
+    */
+    void flush();
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of checkpoints which were written.
+    *
+    * @return uint64_t Number of written checkpoints.
+    */
+    uint64_t get_written();
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of checkpoints which were replaced by a newer one before they were written.
+    *
+    * @return uint64_t Number of replaced checkpoints.
+    */
+    uint64_t get_replaced();
+
+    /**
+     * @brief Error if the directory or a file of the checkpoints could not be created.
+     *
+     */
+    class checkpoint_error : public invalid_argument
+    {
+    public:
+        checkpoint_error(const string &name) : invalid_argument("Could not write the checkpoint " + name + "!"){};
+    };
+
+private:
+    /**
+    * @brief Member function of the thread which writes the submitted snapshots.
+    *
+    */
+    void run();
+
+    /**
+    * @brief Member function to write a snapshot to its file.
+    *
+    * @param state The snapshot.
+    * @return true If the checkpoint was written.
+    * @return false If there was an error.
+    */
+    bool write_file(const checkpoint_state &);
+
+    /**
+     * @brief Paths of the two checkpoint files and their temporary files.
+     *
+     */
+    array<string, 2> paths, temporary_paths;
+
+    /**
+     * @brief The two snapshots.
+     *
+     */
+    array<checkpoint_state, 2> snapshots;
+
+    /**
+     * @brief The snapshot which waits to be written (-1 if none).
+     *
+     */
+    int pending = -1;
+
+    /**
+     * @brief The snapshot which is being written (-1 if none).
+     *
+     */
+    int writing = -1;
+
+    /**
+     * @brief Number of the next checkpoint.
+     *
+     */
+    uint64_t sequence = 1;
+
+    /**
+     * @brief Number of checkpoints which were written.
+     *
+     */
+    uint64_t written = 0;
+
+    /**
+     * @brief Number of checkpoints which were replaced before they were written.
+     *
+     */
+    uint64_t replaced = 0;
+
+    /**
+     * @brief If the thread should stop after writing the waiting snapshot.
+     *
+     */
+    bool stopping = false;
+
+    /**
+     * @brief Mutex for the members shared with the thread.
+     *
+     */
+    mutex snapshots_mutex;
+
+    /**
+     * @brief Notified when a snapshot is submitted or written, or the writer stops.
+     *
+     */
+    condition_variable snapshot_ready;
+
+    /**
+     * @brief The thread which writes the checkpoints.
+     *
+     */
+    thread writer;
+};
+
+/**
+ * @brief Reading the latest valid checkpoint of a directory. A checkpoint is valid if it is complete, its checksum matches and it belongs to a run with the same number of folds and edges. The sizes are checked before anything is allocated, so a corrupt or torn checkpoint is skipped instead of allocating the sizes it claims.
+ *
+ * @param directory Directory of the checkpoints.
+ * @param number_folds Number of folds of the cross validation.
+ * @param expected_edges Number of edges of the network.
+ * @param state The state saved in the checkpoint.
+ * @return true If a valid checkpoint was found.
+ * @return false If there is no valid checkpoint.
+ */
+bool read_checkpoint(const string &, const uint64_t &, const uint64_t &, checkpoint_state &);
+
+/**
+ * @brief Writing bytes to a file and adding them to an FNV-1a checksum.
+ *
+ * @param fd The file.
+ * @param data The bytes.
+ * @param size Number of bytes.
+ * @param checksum The checksum.
+ * @return true If all the bytes were written.
+ * @return false If there was an error.
+ */
+bool write_checked(const int &, const void *, const uint64_t &, uint64_t &);
+
+/**
+ * @brief Reading bytes from a file and adding them to an FNV-1a checksum.
+ *
+ * @param fd The file.
+ * @param data Buffer for the bytes.
+ * @param size Number of bytes.
+ * @param checksum The checksum.
+ * @return true If all the bytes were read.
+ * @return false If the file is shorter.
+ */
+bool read_checked(const int &, void *, const uint64_t &, uint64_t &);
+
+/**
+ * @brief The first characters of a checkpoint file.
+ *
+ */
+constexpr char checkpoint_magic[4] = {'N', 'N', 'C', 'K'};
+
+/**
+ * @brief The version of the checkpoint format.
+ *
+ */
+constexpr uint64_t checkpoint_version = 1;
+
+// ==============
+// Implementation
+// ==============
+
+bool write_checked(const int &fd, const void *data, const uint64_t &size, uint64_t &checksum)
+{
+    const unsigned char *p = static_cast<const unsigned char *>(data);
+    for (uint64_t i = 0; i < size; i++)
+        checksum = (checksum ^ p[i]) * 1099511628211ULL;
+    uint64_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = write(fd, p + done, size - done);
+        if (n <= 0)
+            return false;
+        done += n;
+    }
+    return true;
+}
+
+bool read_checked(const int &fd, void *data, const uint64_t &size, uint64_t &checksum)
+{
+    unsigned char *p = static_cast<unsigned char *>(data);
+    uint64_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = read(fd, p + done, size - done);
+        if (n <= 0)
+            return false;
+        done += n;
+    }
+    for (uint64_t i = 0; i < size; i++)
+        checksum = (checksum ^ p[i]) * 1099511628211ULL;
+    return true;
+}
+
+checkpoint_writer::checkpoint_writer(const string &directory, const uint64_t &number_edges, const uint64_t &number_folds, const uint64_t &first_sequence)
+    : sequence(first_sequence)
+{
+    mkdir(directory.c_str(), 0755);
+    struct stat s;
+    if (stat(directory.c_str(), &s) != 0 || !S_ISDIR(s.st_mode))
+        throw checkpoint_error(directory);
+    for (uint64_t i = 0; i < 2; i++)
+    {
+        paths[i] = directory + "/checkpoint." + to_string(i);
+        temporary_paths[i] = paths[i] + ".tmp";
+        snapshots[i].accuracies.reserve(number_folds);
+        snapshots[i].weights.resize(number_edges);
+        snapshots[i].gradients.resize(number_edges);
+    }
+    writer = thread(&checkpoint_writer::run, this);
+}
+
+checkpoint_writer::~checkpoint_writer()
+{
+    {
+        lock_guard<mutex> lock(snapshots_mutex);
+        stopping = true;
+    }
+    snapshot_ready.notify_all();
+    writer.join();
+}
+
+void checkpoint_writer::submit(const uint64_t &fold, const uint64_t &iteration, const uint64_t &seed, const vector<double> &accuracies, const double &best_accuracy, const vector<edge> &edges)
+{
+    lock_guard<mutex> lock(snapshots_mutex);
+    // The snapshot which is not being written. If a snapshot is still waiting, its checkpoint is replaced by the newer one.
+    int s = pending >= 0 ? pending : (writing == 0 ? 1 : 0);
+    if (pending >= 0)
+        replaced++;
+    checkpoint_state &state = snapshots[s];
+    state.sequence = sequence++;
+    state.fold = fold;
+    state.iteration = iteration;
+    state.seed = seed;
+    state.best_accuracy = best_accuracy;
+    state.accuracies.assign(accuracies.begin(), accuracies.begin() + fold); // Within the reserved capacity.
+    for (uint64_t i = 0; i < edges.size(); i++)
+    {
+        state.weights[i] = edges[i].get_weight();
+        state.gradients[i] = edges[i].get_gradient();
+    }
+    pending = s;
+    snapshot_ready.notify_all();
+}
+
+void checkpoint_writer::flush()
+{
+    unique_lock<mutex> lock(snapshots_mutex);
+    snapshot_ready.wait(lock, [&]()
+                        { return pending < 0 && writing < 0; });
+}
+
+uint64_t checkpoint_writer::get_written()
+{
+    lock_guard<mutex> lock(snapshots_mutex);
+    return written;
+}
+
+uint64_t checkpoint_writer::get_replaced()
+{
+    lock_guard<mutex> lock(snapshots_mutex);
+    return replaced;
+}
+
+void checkpoint_writer::run()
+{
+    unique_lock<mutex> lock(snapshots_mutex);
+    while (true)
+    {
+        snapshot_ready.wait(lock, [&]()
+                            { return pending >= 0 || stopping; });
+        if (pending < 0)
+            break;
+        writing = pending;
+        pending = -1;
+        lock.unlock();
+        bool ok = write_file(snapshots[writing]);
+        lock.lock();
+        writing = -1;
+        if (ok)
+            written++;
+        else
+            cout << "\nError writing the checkpoint!\n";
+        snapshot_ready.notify_all();
+    }
+}
+
+bool checkpoint_writer::write_file(const checkpoint_state &state)
+{
+    // Only system calls are used, so the thread does not allocate while the training loop is checked for allocations.
+    const string &path = paths[state.sequence % 2], &temporary_path = temporary_paths[state.sequence % 2];
+    int fd = open(temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+    uint64_t checksum = 14695981039346656037ULL;
+    uint64_t number_accuracies = state.accuracies.size(), number_edges = state.weights.size();
+    bool ok = write_checked(fd, checkpoint_magic, sizeof(checkpoint_magic), checksum) &&
+              write_checked(fd, &checkpoint_version, sizeof(uint64_t), checksum) &&
+              write_checked(fd, &state.sequence, sizeof(uint64_t), checksum) &&
+              write_checked(fd, &state.fold, sizeof(uint64_t), checksum) &&
+              write_checked(fd, &state.iteration, sizeof(uint64_t), checksum) &&
+              write_checked(fd, &state.seed, sizeof(uint64_t), checksum) &&
+              write_checked(fd, &state.best_accuracy, sizeof(double), checksum) &&
+              write_checked(fd, &number_accuracies, sizeof(uint64_t), checksum) &&
+              write_checked(fd, state.accuracies.data(), number_accuracies * sizeof(double), checksum) &&
+              write_checked(fd, &number_edges, sizeof(uint64_t), checksum) &&
+              write_checked(fd, state.weights.data(), number_edges * sizeof(double), checksum) &&
+              write_checked(fd, state.gradients.data(), number_edges * sizeof(double), checksum);
+    uint64_t unused = 0;
+    ok = ok && write_checked(fd, &checksum, sizeof(uint64_t), unused) && fsync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    return ok && rename(temporary_path.c_str(), path.c_str()) == 0;
+}
+
+bool read_checkpoint(const string &directory, const uint64_t &number_folds, const uint64_t &expected_edges, checkpoint_state &state)
+{
+    bool found = false;
+    for (uint64_t i = 0; i < 2; i++)
+    {
+        int fd = open((directory + "/checkpoint." + to_string(i)).c_str(), O_RDONLY);
+        if (fd < 0)
+            continue;
+        checkpoint_state s;
+        uint64_t checksum = 14695981039346656037ULL, version = 0, number_accuracies = 0, number_edges = 0, saved_checksum = 0, unused = 0;
+        char magic[sizeof(checkpoint_magic)];
+        bool ok = read_checked(fd, magic, sizeof(magic), checksum) && memcmp(magic, checkpoint_magic, sizeof(magic)) == 0 &&
+                  read_checked(fd, &version, sizeof(uint64_t), checksum) && version == checkpoint_version &&
+                  read_checked(fd, &s.sequence, sizeof(uint64_t), checksum) &&
+                  read_checked(fd, &s.fold, sizeof(uint64_t), checksum) && s.fold <= number_folds &&
+                  read_checked(fd, &s.iteration, sizeof(uint64_t), checksum) &&
+                  read_checked(fd, &s.seed, sizeof(uint64_t), checksum) &&
+                  read_checked(fd, &s.best_accuracy, sizeof(double), checksum) &&
+                  read_checked(fd, &number_accuracies, sizeof(uint64_t), checksum) && number_accuracies == s.fold;
+        if (ok)
+        {
+            s.accuracies.resize(number_accuracies);
+            ok = read_checked(fd, s.accuracies.data(), number_accuracies * sizeof(double), checksum) &&
+                 read_checked(fd, &number_edges, sizeof(uint64_t), checksum) && number_edges == expected_edges;
+        }
+        if (ok)
+        {
+            s.weights.resize(number_edges);
+            s.gradients.resize(number_edges);
+            ok = read_checked(fd, s.weights.data(), number_edges * sizeof(double), checksum) &&
+                 read_checked(fd, s.gradients.data(), number_edges * sizeof(double), checksum) &&
+                 read_checked(fd, &saved_checksum, sizeof(uint64_t), unused) && saved_checksum == checksum;
+        }
+        close(fd);
+        if (ok && (!found || s.sequence > state.sequence))
+        {
+            state = s;
+            found = true;
+        }
+    }
+    return found;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file codegen.cpp
+ * @brief Ahead-of-time code generation of a trained neural network model.
+ *
+ * Reads a model saved by main --save-model and writes a standalone C++ source file with constexpr weights and a predict() function, which can be compiled directly into other programs.
+ *
+ * Usage: codegen model.csv output.hpp [namespace]
+ *
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <random>
+#include <fstream>
+#include "activation.hpp"
+#include "thread_pool.hpp"
+#include "counter_rng.hpp"
+#include "edge.hpp"
+#include "standardization.hpp"
+#include "gemm.hpp"
+#include "model.hpp"
+#include "codegen.hpp"
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+     try
+     {
+          if (argc < 3 || argc > 4)
+          {
+               cout << "Usage: " << argv[0] << " model.csv output.hpp [namespace]\n";
+               return -1;
+          }
+          string name = argc == 4 ? argv[3] : "trained_model"; // Namespace of the generated arrays and functions.
+
+          // Reading the trained model.
+          model m(argv[1]);
+
+          // Writing the generated source.
+          ofstream output(argv[2]);
+          if (!output.is_open())
+          {
+               cout << "Error opening " << argv[2] << " output file!";
+               return -1;
+          }
+          generate_source(m, output, name);
+          output.close();
+          cout << "Generated " << argv[2] << " for the model" << m;
+     }
+     catch (const exception &e)
+     {
+          return -1;
+     }
+}
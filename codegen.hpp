@@ -0,0 +1,158 @@
+#include <iostream>
+#include <stdexcept>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief Writes a standalone C++ source file for a trained model. The weights are written as constexpr arrays and the forward propagation is written as loops with constant bounds for each layer, so the generated file does not depend on any header of the network and needs no model file at run time.
+ *
+ * @param m The trained model.
+ * @param out Output stream for the generated source.
+ * @param name Name of the namespace which contains the generated arrays and functions.
+ */
+void generate_source(const model &, ostream &, const string &);
+
+/**
+ * @brief Writes the expression of an activation function for the generated source.
+ *
+ * @param type The activation function.
+ * @param z The name of the variable with the weighted sum of the inputs.
+ * @return string The C++ expression computing the activation.
+ */
+string activation_expression(const activation_type &, const string &);
+
+// ==============
+// Implementation
+// ==============
+
+void generate_source(const model &m, ostream &out, const string &name)
+{
+    vector<uint64_t> number_nodes = m.get_number_nodes();
+    vector<activation_type> activation_functions = m.get_activation_functions();
+    uint64_t number_layers = number_nodes.size();
+
+    out << "// Generated from a trained neural network model. Do not edit.\n";
+    out << "// Layers:";
+    for (const uint64_t &i : number_nodes)
+        out << ' ' << i;
+    out << "\n\n";
+    out << "#pragma once\n\n";
+    out << "#include <cmath>\n";
+    out << "#include <cstdint>\n\n";
+    out << "namespace " << name << "\n{\n";
+    out << "    constexpr std::uint64_t number_features = " << number_nodes[0] << ";\n";
+    out << "    constexpr std::uint64_t number_classes = " << number_nodes[number_layers - 1] << ";\n";
+
+    // Weight matrices. Row j holds the weights of the input edges of neuron j + 1 of layer l + 1, starting with the bias unit.
+    out << setprecision(17);
+    for (uint64_t l = 1; l < number_layers; l++)
+    {
+        const vector<double> &theta = m.get_theta(l);
+        out << "\n    constexpr double theta_" << l << '[' << number_nodes[l] << "][" << number_nodes[l - 1] + 1 << "] = {\n";
+        for (uint64_t j = 0; j < number_nodes[l]; j++)
+        {
+            out << "        {";
+            for (uint64_t k = 0; k <= number_nodes[l - 1]; k++)
+                out << (k == 0 ? "" : ", ") << theta[j * (number_nodes[l - 1] + 1) + k];
+            out << "},\n";
+        }
+        out << "    };\n";
+    }
+
+    // The label of each class, if the labels of the dataset were replaced by class numbers.
+    const vector<int64_t> &labels = m.get_labels();
+    if (!labels.empty())
+    {
+        out << "\n    constexpr std::int64_t labels[" << labels.size() << "] = {";
+        for (uint64_t j = 0; j < labels.size(); j++)
+            out << (j == 0 ? "" : ", ") << labels[j];
+        out << "};\n";
+    }
+
+    // Forward propagation. The activations of layer l are kept in a_l and a_1 is the input.
+    out << "\n    /**\n";
+    out << "     * @brief Computes the activations of the output layer.\n";
+    out << "     *\n";
+    out << "     * @param x Feature values of the instance (Without the bias unit).\n";
+    out << "     * @param y Activations of the output layer.\n";
+    out << "     */\n";
+    out << "    inline void forward(const double *x, double *y)\n    {\n";
+    out << "        const double *a_1 = x;\n";
+    for (uint64_t l = 1; l < number_layers; l++)
+    {
+        string result = l + 1 == number_layers ? "y" : "a_" + to_string(l + 1);
+        if (l + 1 != number_layers)
+            out << "        double " << result << '[' << number_nodes[l] << "];\n";
+        out << "        for (std::uint64_t j = 0; j < " << number_nodes[l] << "; j++)\n        {\n";
+        out << "            double z = theta_" << l << "[j][0];\n";
+        out << "            for (std::uint64_t k = 0; k < " << number_nodes[l - 1] << "; k++)\n";
+        out << "                z += theta_" << l << "[j][k + 1] * a_" << l << "[k];\n";
+        if (activation_functions[l - 1] == activation_type::softmax)
+            out << "            " << result << "[j] = z;\n";
+        else
+            out << "            " << result << "[j] = " << activation_expression(activation_functions[l - 1], "z") << ";\n";
+        out << "        }\n";
+        if (activation_functions[l - 1] == activation_type::softmax)
+        {
+            out << "        double max_input = " << result << "[0];\n";
+            out << "        for (std::uint64_t j = 1; j < " << number_nodes[l] << "; j++)\n";
+            out << "            max_input = " << result << "[j] > max_input ? " << result << "[j] : max_input;\n";
+            out << "        double sum = 0;\n";
+            out << "        for (std::uint64_t j = 0; j < " << number_nodes[l] << "; j++)\n        {\n";
+            out << "            " << result << "[j] = std::exp(" << result << "[j] - max_input);\n";
+            out << "            sum += " << result << "[j];\n";
+            out << "        }\n";
+            out << "        for (std::uint64_t j = 0; j < " << number_nodes[l] << "; j++)\n";
+            out << "            " << result << "[j] /= sum;\n";
+        }
+    }
+    out << "    }\n";
+
+    out << "\n    /**\n";
+    out << "     * @brief Predicts the class of an instance which is the number of the output neuron with the maximum activation.\n";
+    out << "     *\n";
+    out << "     * @param x Feature values of the instance (Without the bias unit).\n";
+    out << (labels.empty() ? "     * @return std::int64_t The predicted class starting from 1.\n" : "     * @return std::int64_t The label of the predicted class.\n");
+    out << "     */\n";
+    out << "    inline std::int64_t predict(const double *x)\n    {\n";
+    out << "        double y[number_classes];\n";
+    out << "        forward(x, y);\n";
+    out << "        std::uint64_t category = 0;\n";
+    out << "        for (std::uint64_t i = 1; i < number_classes; i++)\n";
+    out << "        {\n";
+    out << "            if (y[i] > y[category])\n";
+    out << "                category = i;\n";
+    out << "        }\n";
+    out << (labels.empty() ? "        return category + 1;\n" : "        return labels[category];\n");
+    out << "    }\n";
+    out << "}\n";
+}
+
+string activation_expression(const activation_type &type, const string &z)
+{
+    switch (type)
+    {
+    case activation_type::sigmoid:
+        return "1 / (1 + std::exp(-" + z + "))";
+    case activation_type::tanh:
+        return "std::tanh(" + z + ")";
+    case activation_type::relu:
+        return z + " > 0 ? " + z + " : 0";
+    case activation_type::leaky_relu:
+    {
+        // The slope is written with 17 significant digits, like the weights, so it is the same double as in the network.
+        ostringstream slope;
+        slope << setprecision(17) << leaky_relu_activation::slope;
+        return z + " > 0 ? " + z + " : " + slope.str() + " * " + z;
+    }
+    case activation_type::softmax:
+        return "std::exp(" + z + ")";
+    }
+    return z; // Just written for removing the warning. This line will never be executed in this problem.
+}
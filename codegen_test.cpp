@@ -0,0 +1,114 @@
+/**
+ * @file codegen_test.cpp
+ * @brief Test of the code generated by codegen against the trained model.
+ *
+ * The header written by codegen is compiled into this program, and the class predicted by the generated predict() for each instance of the test set of a fold is compared with model::predict() of the saved model. The test set is split from x.csv with the seed and the train percentage of parameters.csv as in main, and without --seed every row of x.csv is compared. Any mismatch makes the program return a non-zero status. The generated header and its namespace are chosen when this program is compiled:
+ *
+ * main --seed 11 --save-model model.csv
+ * codegen model.csv generated_model.hpp generated_model
+ * g++ -std=c++17 -O2 -DGENERATED_MODEL='"generated_model.hpp"' -DGENERATED_NAMESPACE=generated_model -o codegen_test codegen_test.cpp -lpthread
+ * codegen_test model.csv x.csv --seed 11 [--fold 0]
+ *
+ * Usage: codegen_test model.csv x.csv [--seed n] [--fold k]
+ *
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <random>
+#include <fstream>
+#include <algorithm>
+#include <optional>
+#include "profiler.hpp"
+#include "activation.hpp"
+#include "thread_pool.hpp"
+#include "counter_rng.hpp"
+#include "edge.hpp"
+#include "standardization.hpp"
+#include "read_x.hpp"
+#include "configuration.hpp"
+#include "gemm.hpp"
+#include "model.hpp"
+
+#ifndef GENERATED_MODEL
+#define GENERATED_MODEL "generated_model.hpp"
+#endif
+#ifndef GENERATED_NAMESPACE
+#define GENERATED_NAMESPACE generated_model
+#endif
+#include GENERATED_MODEL
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+     try
+     {
+          if (argc < 3)
+          {
+               cout << "Usage: " << argv[0] << " model.csv x.csv [--seed n] [--fold k]\n";
+               return -1;
+          }
+          optional<uint64_t> seed; // Seed of the split of main (Every row is compared if not given).
+          uint64_t fold = 0;      // The fold whose test set is compared.
+          for (int i = 3; i < argc; i++)
+          {
+               string option = argv[i];
+               if (option == "--seed" && i + 1 < argc)
+                    seed = stoull(argv[++i]);
+               else if (option == "--fold" && i + 1 < argc)
+                    fold = stoull(argv[++i]);
+               else
+               {
+                    cout << "Usage: " << argv[0] << " model.csv x.csv [--seed n] [--fold k]\n";
+                    return -1;
+               }
+          }
+
+          model m(argv[1]);
+          read_x x(argv[2]);
+          if (x.get_cols() != m.get_number_nodes()[0] || GENERATED_NAMESPACE::number_features != m.get_number_nodes()[0])
+          {
+               cout << "The model, the generated code and " << argv[2] << " have different numbers of features!\n";
+               return -1;
+          }
+
+          // The rows of the test set, split as in main: the instances are sorted by the random numbers of the seed and the fold, and the rows after the train percentage are the test set.
+          uint64_t number_instances = x.get_rows();
+          vector<uint64_t> order(number_instances);
+          for (uint64_t i = 0; i < number_instances; i++)
+               order[i] = i;
+          uint64_t first_test = 0;
+          if (seed)
+          {
+               configuration parameters("parameters.csv");
+               vector<double> random_numbers(number_instances);
+               counter_rng(*seed, random_stream::split, fold).fill_uniform(random_numbers);
+               stable_sort(order.begin(), order.end(), [&](const uint64_t &a, const uint64_t &b)
+                           { return random_numbers[a] < random_numbers[b]; });
+               first_test = number_instances * parameters.get_train_percantage() / 100;
+          }
+
+          uint64_t mismatches = 0;
+          vector<double> y(m.get_number_nodes().back()), workspace;
+          for (uint64_t i = first_test; i < number_instances; i++)
+          {
+               const double *features = &x.get_values()[order[i]][1]; // Without the bias unit.
+               m.forward_batch(features, 1, y.data(), workspace);
+               int64_t expected = m.predict(y.data()), generated = GENERATED_NAMESPACE::predict(features);
+               if (expected != generated)
+               {
+                    if (mismatches < 10)
+                         cout << "Row " << order[i] + 1 << ": the model predicts " << expected << " and the generated code " << generated << '\n';
+                    mismatches++;
+               }
+          }
+          cout << "Compared " << number_instances - first_test << " predictions, " << mismatches << " mismatches\n";
+          return mismatches == 0 ? 0 : 1;
+     }
+     catch (const exception &e)
+     {
+          return -1;
+     }
+}
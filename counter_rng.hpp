@@ -0,0 +1,129 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <algorithm>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief The purposes of the random numbers of a run. Each purpose has its own stream, so adding random numbers for one purpose does not change the others.
+ *
+ */
+enum class random_stream : uint64_t
+{
+    weights = 1, // Initial weights of the edges.
+    split = 2,   // Splitting the data into train and test sets.
+    samples = 3, // Classes sampled by the sampled softmax.
+    batches = 4  // Order of the instances of the batches of the batch loader.
+};
+
+/**
+ * @brief Counter-based random number generator (SplitMix64). The random number for a counter is computed directly from a key, which is derived from the seed of the run, the purpose and the fold, and the counter, such as the ID of an edge or the row of an instance. There is no state which changes, so the numbers could be generated in any order and by any number of threads, and the same seed always gives the same numbers.
+ *
+ */
+class counter_rng
+{
+
+public:
+    /**
+    * @brief Construct a new counter rng::counter rng object.
+    *
+    * @param seed Seed of the run.
+    * @param stream The purpose of the random numbers.
+    * @param fold The fold of the cross validation.
+    */
+    counter_rng(const uint64_t & = 0, const random_stream & = random_stream::weights, const uint64_t & = 0);
+
+    /**
+    * @brief Member function to compute the random bits for a counter.
+    *
+    * @param counter The counter.
+    * @return uint64_t 64 random bits.
+    */
+    uint64_t bits(const uint64_t &) const;
+
+    /**
+    * @brief Member function to compute a uniform random number in [0, 1) for a counter.
+    *
+    * @param counter The counter.
+    * @return double The random number.
+    */
+    double uniform(const uint64_t &) const;
+
+    /**
+    * @brief Member function to compute a uniform random number in [a, b) for a counter.
+    *
+    * @param counter The counter.
+    * @param a Lower bound.
+    * @param b Upper bound.
+    * @return double The random number.
+    */
+    double uniform(const uint64_t &, const double &, const double &) const;
+
+    /**
+    * @brief Member function to fill a vector with the uniform random numbers in [0, 1) of the counters 0, 1, 2, ... Large vectors are divided between the threads of the thread pool.
+    *
+    * @param values The vector.
+    */
+    void fill_uniform(vector<double> &) const;
+
+private:
+    /**
+     * @brief The key derived from the seed, purpose and fold.
+     *
+     */
+    uint64_t key = 0;
+};
+
+/**
+ * @brief The SplitMix64 finalizer, which mixes the bits of a number so that nearby numbers give unrelated results.
+ *
+ * @param z The number.
+ * @return uint64_t The mixed bits.
+ */
+uint64_t splitmix64(uint64_t);
+
+// ==============
+// Implementation
+// ==============
+
+uint64_t splitmix64(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+counter_rng::counter_rng(const uint64_t &seed, const random_stream &stream, const uint64_t &fold)
+    : key(splitmix64(splitmix64(splitmix64(seed) ^ (uint64_t)stream) ^ fold))
+{
+}
+
+uint64_t counter_rng::bits(const uint64_t &counter) const
+{
+    // The counter-th output of a SplitMix64 generator whose state starts at the key.
+    return splitmix64(key + (counter + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+double counter_rng::uniform(const uint64_t &counter) const
+{
+    // The upper 53 bits fill the mantissa of a double.
+    return (double)(bits(counter) >> 11) * 0x1.0p-53;
+}
+
+double counter_rng::uniform(const uint64_t &counter, const double &a, const double &b) const
+{
+    return a + (b - a) * uniform(counter);
+}
+
+void counter_rng::fill_uniform(vector<double> &values) const
+{
+    thread_pool::instance().parallel_for(0, values.size(), 1 << 16, [&](const uint64_t &begin, const uint64_t &end)
+                                         {
+                                             for (uint64_t i = begin; i < end; i++)
+                                                 values[i] = uniform(i);
+                                         });
+}
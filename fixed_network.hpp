@@ -0,0 +1,328 @@
+#include <iostream>
+#include <stdexcept>
+#include <array>
+#include <vector>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief The weights of the edges connecting two layers of a network whose sizes are known at compile time.
+ *
+ * @tparam Inputs Number of neurons of the start layer (Except the bias unit).
+ * @tparam Outputs Number of neurons of the end layer.
+ */
+template <uint64_t Inputs, uint64_t Outputs>
+class fixed_layer
+{
+
+public:
+    /**
+    * @brief Member function to compute the activations of the end layer.
+    *
+    * @tparam Activation Activation policy of the end layer.
+    * @param in Activations of the start layer (Without the bias unit).
+    * @param out Activations of the end layer.
+    */
+    template <typename Activation>
+    void forward(const double *, double *) const;
+
+    /**
+    * @brief Member function to copy the weights from the weight matrix of a trained model.
+    *
+    * @param _theta Weight matrix with Outputs rows and Inputs + 1 columns (Column 0 belongs to the bias unit).
+    */
+    void load(const vector<double> &);
+
+private:
+    /**
+     * @brief Weight matrix stored row by row. Each row holds the weights of the input edges of one neuron of the end layer, starting with the bias.
+     *
+     */
+    array<double, Outputs *(Inputs + 1)> theta{};
+};
+
+/**
+ * @brief The layers of a fixed network, stored as the first fixed_layer followed by the rest of the network.
+ *
+ * @tparam Hidden Activation policy of the hidden layers.
+ * @tparam Output Activation policy of the output layer.
+ * @tparam Sizes Number of neurons in each layer (Except the bias unit).
+ */
+template <typename Hidden, typename Output, uint64_t... Sizes>
+class fixed_layers;
+
+template <typename Hidden, typename Output, uint64_t Inputs, uint64_t Outputs>
+class fixed_layers<Hidden, Output, Inputs, Outputs>
+{
+
+public:
+    /**
+     * @brief Number of neurons of the output layer of the network.
+     *
+     */
+    static constexpr uint64_t outputs = Outputs;
+
+    /**
+    * @brief Member function to compute the activations of the output layer.
+    *
+    * @param in Activations of the first layer (Without the bias unit).
+    * @param out Activations of the output layer.
+    */
+    void forward(const double *, double *) const;
+
+    /**
+    * @brief Member function to copy the weights of a trained model starting from a layer.
+    *
+    * @param m The trained model.
+    * @param l The layer number of the model for the first layer.
+    * @return true If the layers and activation functions of the model match.
+    * @return false If the layers or activation functions of the model do not match.
+    */
+    bool load(const model &, const uint64_t &);
+
+private:
+    /**
+     * @brief Weights of the output layer.
+     *
+     */
+    fixed_layer<Inputs, Outputs> head;
+};
+
+template <typename Hidden, typename Output, uint64_t Inputs, uint64_t Outputs, uint64_t... Rest>
+class fixed_layers<Hidden, Output, Inputs, Outputs, Rest...>
+{
+
+public:
+    static constexpr uint64_t outputs = fixed_layers<Hidden, Output, Outputs, Rest...>::outputs;
+    void forward(const double *, double *) const;
+    bool load(const model &, const uint64_t &);
+
+private:
+    /**
+     * @brief Weights of the edges connecting the first layer to the next hidden layer.
+     *
+     */
+    fixed_layer<Inputs, Outputs> head;
+
+    /**
+     * @brief The rest of the network starting from the next hidden layer.
+     *
+     */
+    fixed_layers<Hidden, Output, Outputs, Rest...> tail;
+};
+
+/**
+ * @brief Neural network whose architecture is known at compile time. The weights are kept in std::array, so the loops of the forward propagation have constant bounds which the compiler can unroll and vectorize.
+ *
+ * @tparam Hidden Activation policy of the hidden layers.
+ * @tparam Output Activation policy of the output layer.
+ * @tparam Sizes Number of neurons in each layer (Except the bias unit), starting with the number of features and ending with the number of classes.
+ */
+template <typename Hidden, typename Output, uint64_t... Sizes>
+class basic_fixed_network
+{
+    static_assert(sizeof...(Sizes) >= 2, "A network needs at least an input and an output layer!");
+
+public:
+    /**
+     * @brief Number of features of the input layer.
+     *
+     */
+    static constexpr uint64_t inputs = array<uint64_t, sizeof...(Sizes)>{Sizes...}[0];
+
+    /**
+     * @brief Number of classes of the output layer.
+     *
+     */
+    static constexpr uint64_t outputs = fixed_layers<Hidden, Output, Sizes...>::outputs;
+
+    /**
+    * @brief Construct a new basic_fixed_network object with all the weights equal to zero, which predicts the class numbers.
+    *
+    */
+    basic_fixed_network();
+
+    /**
+    * @brief Construct a new basic_fixed_network object with the weights of a model trained by the network of edges and neurons.
+    *
+    * @param m The trained model.
+    */
+    basic_fixed_network(const model &);
+
+    /**
+    * @brief Member function to copy the weights and the labels of a trained model. The architecture and activation functions of the model must be the same as the template arguments.
+    *
+    * @param m The trained model.
+    */
+    void load(const model &);
+
+    /**
+    * @brief Member function to compute the activations of the output layer for an instance.
+    *
+    * @param x Feature values of the instance (Without the bias unit).
+    * @return array<double, outputs> Activations of the output layer.
+    */
+    array<double, outputs> forward(const double *) const;
+
+    /**
+    * @brief Member function to predict the class of an instance which is the number of the output neuron with the maximum activation, as model::predict().
+    *
+    * @param x Feature values of the instance (Without the bias unit).
+    * @return int64_t The label of the predicted class (The class number starting from 1 if the model has no labels).
+    */
+    int64_t predict(const double *) const;
+
+    /**
+     * @brief Error if the architecture of the model is not the same as the fixed network.
+     *
+     */
+    class architecture_mismatch : public invalid_argument
+    {
+    public:
+        architecture_mismatch() : invalid_argument("The layers or activation functions of the model are not the same as the fixed network!"){};
+    };
+
+private:
+    /**
+     * @brief The layers of the network.
+     *
+     */
+    fixed_layers<Hidden, Output, Sizes...> layers;
+
+    /**
+     * @brief The label of each output neuron, which is the class number if the model has no labels.
+     *
+     */
+    array<int64_t, outputs> labels;
+};
+
+/**
+ * @brief Fixed network with sigmoid activations for all the layers, which is the default of the network of edges and neurons.
+ *
+ * @tparam Sizes Number of neurons in each layer (Except the bias unit).
+ */
+template <uint64_t... Sizes>
+using fixed_network = basic_fixed_network<sigmoid_activation, sigmoid_activation, Sizes...>;
+
+// ==============
+// Implementation
+// ==============
+
+template <uint64_t Inputs, uint64_t Outputs>
+template <typename Activation>
+void fixed_layer<Inputs, Outputs>::forward(const double *in, double *out) const
+{
+    for (uint64_t j = 0; j < Outputs; j++)
+    {
+        const double *row = &theta[j * (Inputs + 1)];
+        double z = row[0];
+        for (uint64_t k = 0; k < Inputs; k++)
+            z += row[k + 1] * in[k];
+        out[j] = z;
+    }
+
+    if constexpr (Activation::normalizes_layer)
+    {
+        double max_input = out[0];
+        for (uint64_t j = 1; j < Outputs; j++)
+            max_input = max(max_input, out[j]);
+        double sum = 0;
+        for (uint64_t j = 0; j < Outputs; j++)
+        {
+            out[j] = Activation::activate(out[j] - max_input);
+            sum += out[j];
+        }
+        for (uint64_t j = 0; j < Outputs; j++)
+            out[j] /= sum;
+    }
+    else
+    {
+        for (uint64_t j = 0; j < Outputs; j++)
+            out[j] = Activation::activate(out[j]);
+    }
+}
+
+template <uint64_t Inputs, uint64_t Outputs>
+void fixed_layer<Inputs, Outputs>::load(const vector<double> &_theta)
+{
+    copy(_theta.begin(), _theta.end(), theta.begin());
+}
+
+template <typename Hidden, typename Output, uint64_t Inputs, uint64_t Outputs>
+void fixed_layers<Hidden, Output, Inputs, Outputs>::forward(const double *in, double *out) const
+{
+    head.template forward<Output>(in, out);
+}
+
+template <typename Hidden, typename Output, uint64_t Inputs, uint64_t Outputs>
+bool fixed_layers<Hidden, Output, Inputs, Outputs>::load(const model &m, const uint64_t &l)
+{
+    if (m.get_number_nodes()[l - 1] != Inputs || m.get_number_nodes()[l] != Outputs || m.get_activation_functions()[l - 1] != Output::type)
+        return false;
+    head.load(m.get_theta(l));
+    return true;
+}
+
+template <typename Hidden, typename Output, uint64_t Inputs, uint64_t Outputs, uint64_t... Rest>
+void fixed_layers<Hidden, Output, Inputs, Outputs, Rest...>::forward(const double *in, double *out) const
+{
+    array<double, Outputs> activation;
+    head.template forward<Hidden>(in, activation.data());
+    tail.forward(activation.data(), out);
+}
+
+template <typename Hidden, typename Output, uint64_t Inputs, uint64_t Outputs, uint64_t... Rest>
+bool fixed_layers<Hidden, Output, Inputs, Outputs, Rest...>::load(const model &m, const uint64_t &l)
+{
+    if (m.get_number_nodes()[l - 1] != Inputs || m.get_number_nodes()[l] != Outputs || m.get_activation_functions()[l - 1] != Hidden::type)
+        return false;
+    head.load(m.get_theta(l));
+    return tail.load(m, l + 1);
+}
+
+template <typename Hidden, typename Output, uint64_t... Sizes>
+basic_fixed_network<Hidden, Output, Sizes...>::basic_fixed_network()
+{
+    for (uint64_t i = 0; i < outputs; i++)
+        labels[i] = i + 1;
+}
+
+template <typename Hidden, typename Output, uint64_t... Sizes>
+basic_fixed_network<Hidden, Output, Sizes...>::basic_fixed_network(const model &m)
+{
+    load(m);
+}
+
+template <typename Hidden, typename Output, uint64_t... Sizes>
+void basic_fixed_network<Hidden, Output, Sizes...>::load(const model &m)
+{
+    if (m.get_number_nodes().size() != sizeof...(Sizes) || !layers.load(m, 1))
+        throw architecture_mismatch();
+    const vector<int64_t> &model_labels = m.get_labels();
+    for (uint64_t i = 0; i < outputs; i++)
+        labels[i] = model_labels.empty() ? i + 1 : model_labels[i];
+}
+
+template <typename Hidden, typename Output, uint64_t... Sizes>
+array<double, basic_fixed_network<Hidden, Output, Sizes...>::outputs> basic_fixed_network<Hidden, Output, Sizes...>::forward(const double *x) const
+{
+    array<double, outputs> activation;
+    layers.forward(x, activation.data());
+    return activation;
+}
+
+template <typename Hidden, typename Output, uint64_t... Sizes>
+int64_t basic_fixed_network<Hidden, Output, Sizes...>::predict(const double *x) const
+{
+    array<double, outputs> activation = forward(x);
+    uint64_t category = 0;
+    for (uint64_t i = 1; i < outputs; i++)
+    {
+        if (activation[i] > activation[category])
+            category = i;
+    }
+    return labels[category];
+}
@@ -0,0 +1,209 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief Rows of the block of the micro-kernel of gemm(). The MR × NR block of C is kept in registers while a row of a sliver of A and a row of a sliver of B are loaded for each of the kc steps.
+ *
+ */
+constexpr uint64_t gemm_mr = 4;
+
+/**
+ * @brief Columns of the block of the micro-kernel of gemm() (Two 256-bit or four 128-bit vectors of doubles).
+ *
+ */
+constexpr uint64_t gemm_nr = 8;
+
+/**
+ * @brief Depth of the packed blocks of gemm(): a sliver of B (kc × NR, 16 KiB) stays in the L1 cache while the slivers of A are multiplied with it.
+ *
+ */
+constexpr uint64_t gemm_kc = 256;
+
+/**
+ * @brief Rows of the packed block of A of gemm(), which stays in the L2 cache (mc × kc, 192 KiB).
+ *
+ */
+constexpr uint64_t gemm_mc = 96;
+
+/**
+ * @brief Columns of the packed panel of B of gemm(), which stays in the L3 cache (kc × nc, 4 MiB).
+ *
+ */
+constexpr uint64_t gemm_nc = 2048;
+
+/**
+ * @brief Columns of the tiles of C which are computed in parallel: a tile of mc × nt reads a packed block of A and 32 slivers of B.
+ *
+ */
+constexpr uint64_t gemm_nt = 256;
+
+/**
+ * @brief Smallest number of multiply-adds of a panel for which gemm() uses the thread pool.
+ *
+ */
+constexpr uint64_t gemm_parallel_flops = 1 << 21;
+
+/**
+ * @brief Number of doubles of the workspace of gemm() for a product of these sizes.
+ *
+ * @param m Rows of C.
+ * @param n Columns of C.
+ * @param k Length of the dot products.
+ * @return uint64_t The size of the packed rows of A and the packed panel of B.
+ */
+uint64_t gemm_workspace_size(const uint64_t &, const uint64_t &, const uint64_t &);
+
+/**
+ * @brief Matrix product C = beta C + op(A) op(B) of row-major matrices, where op(A) is m × k and op(B) is k × n, without an external BLAS. The columns of C are split into panels of nc, the dot products into blocks of kc and the rows of C into blocks of mc. Each panel of op(B) and the rows of op(A) are copied once into slivers of NR columns and MR rows which are read contiguously by the micro-kernel, so the weights of a wide layer are read from memory once per panel instead of once per row. Large products pack the slivers and compute the tiles of mc × nt of C with the thread pool, nested in the loop of the caller if it is a task of the pool as well. The micro-kernel starts from the value of C and adds the products in order of k, so for k <= kc each element is rounded as in a plain loop which starts from C.
+ *
+ * @param transpose_a If A is stored k × m (op(A) = A^T) instead of m × k.
+ * @param transpose_b If B is stored n × k (op(B) = B^T) instead of k × n.
+ * @param m Rows of C.
+ * @param n Columns of C.
+ * @param k Length of the dot products.
+ * @param a The matrix A.
+ * @param lda Distance between the rows of A.
+ * @param b The matrix B.
+ * @param ldb Distance between the rows of B.
+ * @param beta C is multiplied by beta before the product is added (C is not read if beta is 0).
+ * @param c The matrix C.
+ * @param ldc Distance between the rows of C.
+ * @param workspace Memory for the packed blocks (At least gemm_workspace_size() doubles, so nothing is allocated).
+ */
+void gemm(const bool &, const bool &, const uint64_t &, const uint64_t &, const uint64_t &, const double *, const uint64_t &, const double *, const uint64_t &, const double &, double *, const uint64_t &, double *);
+
+/**
+ * @brief Micro-kernel of gemm(): adds the product of a packed sliver of A and a packed sliver of B to an MR × NR block of C.
+ *
+ * @param kc Length of the slivers.
+ * @param a The sliver of A (kc groups of MR values).
+ * @param b The sliver of B (kc groups of NR values).
+ * @param c The block of C.
+ * @param ldc Distance between the rows of C.
+ * @param mr Rows of the block inside C (At most MR).
+ * @param nr Columns of the block inside C (At most NR).
+ */
+void gemm_kernel(const uint64_t &, const double *, const double *, double *, const uint64_t &, const uint64_t &, const uint64_t &);
+
+// ==============
+// Implementation
+// ==============
+
+uint64_t gemm_workspace_size(const uint64_t &m, const uint64_t &n, const uint64_t &k)
+{
+    uint64_t mc = (m + gemm_mr - 1) / gemm_mr * gemm_mr;
+    uint64_t nc = (min(n, gemm_nc) + gemm_nr - 1) / gemm_nr * gemm_nr;
+    return (mc + nc) * min(k, gemm_kc);
+}
+
+void gemm(const bool &transpose_a, const bool &transpose_b, const uint64_t &m, const uint64_t &n, const uint64_t &k, const double *a, const uint64_t &lda, const double *b, const uint64_t &ldb, const double &beta, double *c, const uint64_t &ldc, double *workspace)
+{
+    if (beta != 1)
+    {
+        for (uint64_t i = 0; i < m; i++)
+            for (uint64_t j = 0; j < n; j++)
+                c[i * ldc + j] = beta == 0 ? 0 : beta * c[i * ldc + j];
+    }
+    if (m == 0 || n == 0 || k == 0)
+        return;
+    thread_pool &pool = thread_pool::instance();
+    double *packed_a = workspace;
+    double *packed_b = packed_a + (m + gemm_mr - 1) / gemm_mr * gemm_mr * min(k, gemm_kc);
+    uint64_t row_blocks = (m + gemm_mc - 1) / gemm_mc;
+
+    for (uint64_t jc = 0; jc < n; jc += gemm_nc)
+    {
+        uint64_t nc = min(gemm_nc, n - jc);
+        // Small products are run by the calling thread, since a range should take a few microseconds.
+        bool parallel = m * nc * k >= gemm_parallel_flops;
+        uint64_t column_blocks = (nc + gemm_nt - 1) / gemm_nt;
+        for (uint64_t pc = 0; pc < k; pc += gemm_kc)
+        {
+            uint64_t kc = min(gemm_kc, k - pc);
+
+            // Packing the panel of op(B) into slivers of NR columns, padded with zeros.
+            auto pack_b = [&](const uint64_t &begin, const uint64_t &end)
+            {
+                for (uint64_t s = begin * gemm_nr; s < min(nc, end * gemm_nr); s += gemm_nr)
+                {
+                    double *sliver = packed_b + s * kc;
+                    for (uint64_t p = 0; p < kc; p++)
+                        for (uint64_t j = 0; j < gemm_nr; j++)
+                        {
+                            uint64_t column = jc + s + j;
+                            sliver[p * gemm_nr + j] = s + j >= nc ? 0 : transpose_b ? b[column * ldb + pc + p]
+                                                                                    : b[(pc + p) * ldb + column];
+                        }
+                }
+            };
+            // Packing all the rows of op(A) into slivers of MR rows, padded with zeros. Since mc is a multiple of MR, the block of rows ic starts at packed_a + ic * kc.
+            auto pack_a = [&](const uint64_t &begin, const uint64_t &end)
+            {
+                for (uint64_t s = begin * gemm_mr; s < min(m, end * gemm_mr); s += gemm_mr)
+                {
+                    double *sliver = packed_a + s * kc;
+                    for (uint64_t p = 0; p < kc; p++)
+                        for (uint64_t i = 0; i < gemm_mr; i++)
+                        {
+                            uint64_t row = s + i;
+                            sliver[p * gemm_mr + i] = row >= m ? 0 : transpose_a ? a[(pc + p) * lda + row]
+                                                                                 : a[row * lda + pc + p];
+                        }
+                }
+            };
+            // Each tile of mc rows and nt columns of C is computed by one range, so the rows of C are written by one thread and added in the same order by any number of threads.
+            auto multiply = [&](const uint64_t &begin, const uint64_t &end)
+            {
+                for (uint64_t tile = begin; tile < end; tile++)
+                {
+                    uint64_t ic = tile / column_blocks * gemm_mc, mc = min(gemm_mc, m - ic);
+                    uint64_t jt = tile % column_blocks * gemm_nt, nt = min(gemm_nt, nc - jt);
+                    for (uint64_t jr = jt; jr < jt + nt; jr += gemm_nr)
+                        for (uint64_t ir = 0; ir < mc; ir += gemm_mr)
+                            gemm_kernel(kc, packed_a + (ic + ir) * kc, packed_b + jr * kc, c + (ic + ir) * ldc + jc + jr, ldc, min(gemm_mr, mc - ir), min(gemm_nr, nc - jr));
+                }
+            };
+            uint64_t b_slivers = (nc + gemm_nr - 1) / gemm_nr, a_slivers = (m + gemm_mr - 1) / gemm_mr;
+            if (!parallel)
+            {
+                pack_b(0, b_slivers);
+                pack_a(0, a_slivers);
+                multiply(0, row_blocks * column_blocks);
+                continue;
+            }
+            pool.parallel_for(0, b_slivers, 16, pack_b);
+            pool.parallel_for(0, a_slivers, 16, pack_a);
+            pool.parallel_for(0, row_blocks * column_blocks, 1, multiply);
+        }
+    }
+}
+
+void gemm_kernel(const uint64_t &kc, const double *a, const double *b, double *c, const uint64_t &ldc, const uint64_t &mr, const uint64_t &nr)
+{
+    double ab[gemm_mr][gemm_nr];
+    for (uint64_t i = 0; i < gemm_mr; i++)
+        for (uint64_t j = 0; j < gemm_nr; j++)
+            ab[i][j] = i < mr && j < nr ? c[i * ldc + j] : 0;
+
+    // The loops over the block are unrolled, so the compiler keeps the block in vector registers instead of reading and writing it at each step.
+    for (uint64_t p = 0; p < kc; p++)
+    {
+        const double *ap = a + p * gemm_mr;
+        const double *bp = b + p * gemm_nr;
+#pragma GCC unroll 8
+        for (uint64_t i = 0; i < gemm_mr; i++)
+#pragma GCC unroll 8
+            for (uint64_t j = 0; j < gemm_nr; j++)
+                ab[i][j] += ap[i] * bp[j];
+    }
+
+    for (uint64_t i = 0; i < mr; i++)
+        for (uint64_t j = 0; j < nr; j++)
+            c[i * ldc + j] = ab[i][j];
+}
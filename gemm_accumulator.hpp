@@ -0,0 +1,337 @@
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief Accumulation of the deltas of the edges over the instances of a train set with matrix products, for networks with wide hidden layers whose weights do not fit in the cache. The weights theta^l of each layer are copied into a contiguous matrix in the order of the edges, and the instances are propagated in blocks: the weighted sums of a block are A^(l+1) = A^l (theta^l)^T, the errors are E^l = E^(l+1) theta^l (Without the column of the bias) times the derivative of the activations, and the deltas are Delta^l += (E^(l+1))^T A^l, all computed by gemm(). The products add the terms in the same order as forward_propagation() and back_propagation() of one instance after the other, so the deltas are the same as the deltas of the single-threaded loop. The blocks are copied from the rows of the train set, or read directly from the contiguous buffers of a batch_loader which gathers them in the background. All the matrices are allocated by the constructor.
+ *
+ */
+class gemm_accumulator
+{
+
+public:
+    /**
+    * @brief Construct a new gemm accumulator::gemm accumulator object and allocate the matrices for the layers of a network.
+    *
+    * @param layers A vector containing all the layers of the network.
+    * @param neurons A vector containing all the neurons of the network.
+    * @param _block_rows Number of instances which are propagated together.
+    * @param huge_pages If the weights and deltas should use transparent huge pages.
+    */
+    gemm_accumulator(const vector<layer> &, const vector<neuron> &, const uint64_t & = 256, const bool & = false);
+
+    /**
+    * @brief Member function to set the delta of each edge to the sum of the deltas of a range of instances, computed with the current weights.
+    *
+    * @param N The network.
+    * @param edges A vector containing all the edges of the network.
+    * @param x Features of the train set.
+    * @param classes The class of each instance of the train set (Starting from 1).
+    * @param begin The first instance.
+    * @param end The instance after the last one.
+    */
+    void accumulate(network &, vector<edge> &, const vector<vector<double>> &, const vector<uint64_t> &, const uint64_t &, const uint64_t &);
+
+    /**
+    * @brief Member function to set the delta of each edge to the sum of the deltas of the instances of the next epoch of a batch loader, which are read from the contiguous buffers of the loader instead of being copied into the block.
+    *
+    * @param N The network.
+    * @param edges A vector containing all the edges of the network.
+    * @param loader The batch loader, whose batches should have at most get_block_rows() instances.
+    */
+    void accumulate(network &, vector<edge> &, batch_loader &);
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of instances which are propagated together.
+    *
+    * @return uint64_t Number of instances.
+    */
+    uint64_t get_block_rows() const;
+
+private:
+    /**
+    * @brief Member function to add the deltas of a block of instances to the deltas.
+    *
+    * @param input Features of the instances stored row by row, with the bias unit as the first column.
+    * @param block_classes The class of each instance (Starting from 1).
+    * @param rows Number of instances (At most block_rows).
+    */
+    void accumulate_block(const double *, const uint64_t *, const uint64_t &);
+
+    /**
+    * @brief Member function to compute the activations of layer l + 1 of a block from the weighted sums.
+    *
+    * @tparam Activation Activation policy of layer l + 1.
+    * @param l Layer number where the edges start.
+    * @param rows Number of instances of the block.
+    */
+    template <typename Activation>
+    void activate_block(const uint64_t &, const uint64_t &);
+
+    /**
+    * @brief Member function to multiply the errors of hidden layer l of a block by the derivative of its activation function.
+    *
+    * @tparam Activation Activation policy of layer l.
+    * @param l Layer number.
+    * @param rows Number of instances of the block.
+    */
+    template <typename Activation>
+    void derive_block(const uint64_t &, const uint64_t &);
+
+    /**
+     * @brief Number of instances which are propagated together.
+     *
+     */
+    uint64_t block_rows = 256;
+
+    /**
+     * @brief The number of neurons of each layer (Except the bias unit).
+     *
+     */
+    vector<uint64_t> number_nodes;
+
+    /**
+     * @brief Activation function of each layer except the input layer.
+     *
+     */
+    vector<activation_type> activation_functions;
+
+    /**
+     * @brief Position of the first edge of each layer, where theta^l starts in the weights and Delta^l in the deltas.
+     *
+     */
+    vector<uint64_t> offsets;
+
+    /**
+     * @brief Weight of each edge (theta^l is number_nodes[l] × (number_nodes[l - 1] + 1) starting at offsets[l - 1]).
+     *
+     */
+    vector<double> weights;
+
+    /**
+     * @brief Delta of each edge, in the same order as the weights.
+     *
+     */
+    vector<double> deltas;
+
+    /**
+     * @brief Activations of each layer for a block, stored row by row. The first column of the input and hidden layers is the bias unit.
+     *
+     */
+    vector<vector<double>> activations;
+
+    /**
+     * @brief Errors of the hidden and output layers for a block, stored row by row (errors[l - 1] is layer l).
+     *
+     */
+    vector<vector<double>> errors;
+
+    /**
+     * @brief Memory for the packed blocks of gemm().
+     *
+     */
+    vector<double> packing;
+};
+
+// ==============
+// Implementation
+// ==============
+
+gemm_accumulator::gemm_accumulator(const vector<layer> &layers, const vector<neuron> &neurons, const uint64_t &_block_rows, const bool &huge_pages)
+    : block_rows(max<uint64_t>(_block_rows, 1))
+{
+    uint64_t number_layers = layers.size();
+    for (uint64_t l = 0; l < number_layers; l++)
+    {
+        // The layer neurons start with the bias unit, except in the output layer.
+        number_nodes.push_back(neurons[layers[l].get_layer_neurons().back() - 1].get_number());
+        if (l > 0)
+            activation_functions.push_back(layers[l].get_activation_function());
+    }
+
+    offsets.push_back(0);
+    uint64_t packing_size = 0;
+    for (uint64_t l = 1; l < number_layers; l++)
+    {
+        offsets.push_back(offsets.back() + number_nodes[l] * (number_nodes[l - 1] + 1));
+        packing_size = max({packing_size, gemm_workspace_size(block_rows, number_nodes[l], number_nodes[l - 1] + 1), gemm_workspace_size(block_rows, number_nodes[l - 1], number_nodes[l]), gemm_workspace_size(number_nodes[l], number_nodes[l - 1] + 1, block_rows)});
+    }
+    weights.resize(offsets.back());
+    deltas.resize(offsets.back());
+    if (huge_pages)
+    {
+        advise_huge_pages(weights.data(), weights.size() * sizeof(double));
+        advise_huge_pages(deltas.data(), deltas.size() * sizeof(double));
+    }
+    packing.resize(packing_size);
+
+    for (uint64_t l = 0; l < number_layers; l++)
+    {
+        uint64_t columns = l + 1 == number_layers ? number_nodes[l] : number_nodes[l] + 1;
+        activations.emplace_back(block_rows * columns, 1); // The bias units stay 1 since the products only write the other columns.
+        if (l > 0)
+            errors.emplace_back(block_rows * number_nodes[l]);
+    }
+}
+
+void gemm_accumulator::accumulate(network &N, vector<edge> &edges, const vector<vector<double>> &x, const vector<uint64_t> &classes, const uint64_t &begin, const uint64_t &end)
+{
+    for (uint64_t i = 0; i < edges.size(); i++)
+        weights[i] = edges[i].get_weight();
+    fill(deltas.begin(), deltas.end(), 0);
+
+    for (uint64_t block_begin = begin; block_begin < end; block_begin += block_rows)
+    {
+        uint64_t rows = min(block_rows, end - block_begin);
+        {
+            PROFILE_SCOPE(forward);
+            for (uint64_t r = 0; r < rows; r++)
+                copy(x[block_begin + r].begin(), x[block_begin + r].end(), &activations[0][r * (number_nodes[0] + 1)]);
+        }
+        accumulate_block(activations[0].data(), &classes[block_begin], rows);
+    }
+    N.set_deltas(edges, deltas);
+}
+
+void gemm_accumulator::accumulate(network &N, vector<edge> &edges, batch_loader &loader)
+{
+    for (uint64_t i = 0; i < edges.size(); i++)
+        weights[i] = edges[i].get_weight();
+    fill(deltas.begin(), deltas.end(), 0);
+    while (const loaded_batch *batch = loader.next())
+    {
+        accumulate_block(batch->x, batch->classes, batch->rows);
+        loader.release();
+    }
+    N.set_deltas(edges, deltas);
+}
+
+uint64_t gemm_accumulator::get_block_rows() const
+{
+    return block_rows;
+}
+
+void gemm_accumulator::accumulate_block(const double *input, const uint64_t *block_classes, const uint64_t &rows)
+{
+    uint64_t number_layers = number_nodes.size();
+    {
+        PROFILE_SCOPE(forward);
+        // The weighted sums of layer l + 1 include the bias, since the first column of A^l is 1.
+        for (uint64_t l = 1; l < number_layers; l++)
+        {
+            uint64_t inputs = number_nodes[l - 1] + 1, outputs = number_nodes[l];
+            bool output_layer = l + 1 == number_layers;
+            gemm(false, true, rows, outputs, inputs, l == 1 ? input : activations[l - 1].data(), inputs, &weights[offsets[l - 1]], inputs, 0, activations[l].data() + (output_layer ? 0 : 1), output_layer ? outputs : outputs + 1, packing.data());
+            switch (activation_functions[l - 1])
+            {
+            case activation_type::sigmoid:
+                activate_block<sigmoid_activation>(l, rows);
+                break;
+            case activation_type::tanh:
+                activate_block<tanh_activation>(l, rows);
+                break;
+            case activation_type::relu:
+                activate_block<relu_activation>(l, rows);
+                break;
+            case activation_type::leaky_relu:
+                activate_block<leaky_relu_activation>(l, rows);
+                break;
+            case activation_type::softmax:
+                activate_block<softmax_activation>(l, rows);
+                break;
+            }
+        }
+    }
+
+    {
+        PROFILE_SCOPE(error);
+        // Setting the errors of the last layer using the class of each instance.
+        uint64_t outputs = number_nodes.back();
+        for (uint64_t r = 0; r < rows; r++)
+            for (uint64_t j = 0; j < outputs; j++)
+                errors.back()[r * outputs + j] = activations.back()[r * outputs + j] - (j + 1 == block_classes[r] ? 1 : 0);
+
+        for (uint64_t l = number_layers - 2; l > 0; l--)
+        {
+            uint64_t hidden = number_nodes[l], next = number_nodes[l + 1];
+            gemm(false, false, rows, hidden, next, errors[l].data(), next, &weights[offsets[l]] + 1, hidden + 1, 0, errors[l - 1].data(), hidden, packing.data());
+            switch (activation_functions[l - 1])
+            {
+            case activation_type::sigmoid:
+                derive_block<sigmoid_activation>(l, rows);
+                break;
+            case activation_type::tanh:
+                derive_block<tanh_activation>(l, rows);
+                break;
+            case activation_type::relu:
+                derive_block<relu_activation>(l, rows);
+                break;
+            case activation_type::leaky_relu:
+                derive_block<leaky_relu_activation>(l, rows);
+                break;
+            case activation_type::softmax:
+                derive_block<softmax_activation>(l, rows);
+                break;
+            }
+        }
+    }
+
+    {
+        PROFILE_SCOPE(delta);
+        for (uint64_t l = 1; l < number_layers; l++)
+        {
+            uint64_t inputs = number_nodes[l - 1] + 1, outputs = number_nodes[l];
+            gemm(true, false, outputs, inputs, rows, errors[l - 1].data(), outputs, l == 1 ? input : activations[l - 1].data(), inputs, 1, &deltas[offsets[l - 1]], inputs, packing.data());
+        }
+    }
+}
+
+template <typename Activation>
+void gemm_accumulator::activate_block(const uint64_t &l, const uint64_t &rows)
+{
+    uint64_t outputs = number_nodes[l];
+    bool output_layer = l + 1 == number_nodes.size();
+    for (uint64_t r = 0; r < rows; r++)
+    {
+        double *a = output_layer ? &activations[l][r * outputs] : &activations[l][r * (outputs + 1) + 1];
+        if constexpr (Activation::normalizes_layer)
+        {
+            double max_input = -numeric_limits<double>::infinity();
+            for (uint64_t j = 0; j < outputs; j++)
+                max_input = max(max_input, a[j]);
+            double sum = 0;
+            for (uint64_t j = 0; j < outputs; j++)
+            {
+                a[j] = Activation::activate(a[j] - max_input);
+                sum += a[j];
+            }
+            for (uint64_t j = 0; j < outputs; j++)
+                a[j] /= sum;
+        }
+        else
+        {
+            for (uint64_t j = 0; j < outputs; j++)
+                a[j] = Activation::activate(a[j]);
+        }
+    }
+}
+
+template <typename Activation>
+void gemm_accumulator::derive_block(const uint64_t &l, const uint64_t &rows)
+{
+    uint64_t hidden = number_nodes[l];
+    for (uint64_t r = 0; r < rows; r++)
+    {
+        double *e = &errors[l - 1][r * hidden];
+        const double *a = &activations[l][r * (hidden + 1) + 1];
+        for (uint64_t j = 0; j < hidden; j++)
+            e[j] *= Activation::derivative(a[j]);
+    }
+}
@@ -0,0 +1,161 @@
+/**
+ * @file generate.cpp
+ * @brief Synthetic dataset generator for load testing.
+ *
+ * Writes a dataset in the format of x.csv and y.csv, or in the binary form of binary_dataset.hpp. Each class has a random center and the features of a row are the center of its class plus standard normal noise. The centers are drawn with a standard deviation equal to the separability, so larger values make the classes easier to separate. The rows are written while they are generated, so the dataset never has to fit in memory.
+ *
+ * The output files have no defaults, so the dataset of the current directory is never overwritten by accident: either --x and --y or --binary is required.
+ *
+ * Usage: generate [--rows 1000] [--features 13] [--classes 3] [--separability 1] [--seed 0] (--x x.csv --y y.csv | --binary dataset.bin)
+ *
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <random>
+#include <fstream>
+#include <charconv>
+#include "binary_dataset.hpp"
+
+using namespace std;
+
+/**
+ * @brief Size of the buffers for writing the text files.
+ *
+ */
+constexpr uint64_t buffer_size = 1 << 20;
+
+/**
+ * @brief Appending a number to a text buffer and writing the buffer to the file when it is almost full.
+ *
+ * @param output The file.
+ * @param buffer The text buffer.
+ * @param length Number of characters in the buffer.
+ * @param value The number.
+ * @param separator The character written after the number.
+ */
+void append_number(ofstream &output, vector<char> &buffer, uint64_t &length, const double &value, const char &separator)
+{
+     if (length + 64 > buffer.size())
+     {
+          output.write(buffer.data(), length);
+          length = 0;
+     }
+     // Fixed notation since read_x does not accept exponents.
+     length = to_chars(buffer.data() + length, buffer.data() + buffer.size(), value, chars_format::fixed, 6).ptr - buffer.data();
+     buffer[length++] = separator;
+}
+
+int main(int argc, char *argv[])
+{
+     try
+     {
+          // Reading the command line options.
+          uint64_t number_rows = 1000;
+          uint64_t number_features = 13;
+          uint64_t number_classes = 3;
+          double separability = 1;
+          uint64_t seed = 0;
+          string x_filename, y_filename, binary_filename; // The output files, which should be given.
+          for (int i = 1; i < argc; i++)
+          {
+               string option = argv[i];
+               if (i + 1 >= argc)
+                    option = "";
+               if (option == "--rows")
+                    number_rows = stoull(argv[++i]);
+               else if (option == "--features")
+                    number_features = stoull(argv[++i]);
+               else if (option == "--classes")
+                    number_classes = stoull(argv[++i]);
+               else if (option == "--separability")
+                    separability = stod(argv[++i]);
+               else if (option == "--seed")
+                    seed = stoull(argv[++i]);
+               else if (option == "--x")
+                    x_filename = argv[++i];
+               else if (option == "--y")
+                    y_filename = argv[++i];
+               else if (option == "--binary")
+                    binary_filename = argv[++i];
+               else
+               {
+                    cout << "Usage: " << argv[0] << " [--rows 1000] [--features 13] [--classes 3] [--separability 1] [--seed 0] (--x x.csv --y y.csv | --binary dataset.bin)\n";
+                    return -1;
+               }
+          }
+          // Either the text files or the binary file.
+          if (binary_filename.empty() ? x_filename.empty() || y_filename.empty() : !x_filename.empty() || !y_filename.empty())
+          {
+               cout << "Usage: " << argv[0] << " [--rows 1000] [--features 13] [--classes 3] [--separability 1] [--seed 0] (--x x.csv --y y.csv | --binary dataset.bin)\n";
+               return -1;
+          }
+          if (number_features == 0 || number_classes == 0)
+          {
+               cout << "The number of features and classes should be positive!\n";
+               return -1;
+          }
+
+          mt19937_64 mt(seed);
+          normal_distribution<double> nd(0, 1);
+          uniform_int_distribution<uint64_t> uid(1, number_classes);
+
+          // Random center of each class.
+          vector<vector<double>> centers(number_classes, vector<double>(number_features));
+          for (vector<double> &c : centers)
+          {
+               for (double &j : c)
+                    j = separability * nd(mt);
+          }
+
+          vector<double> row(number_features); // Feature values of the current row.
+          if (!binary_filename.empty())
+          {
+               write_binary output(binary_filename, number_features);
+               for (uint64_t i = 0; i < number_rows; i++)
+               {
+                    uint64_t category = uid(mt);
+                    for (uint64_t j = 0; j < number_features; j++)
+                         row[j] = centers[category - 1][j] + nd(mt);
+                    output.write_row(row.data(), category);
+               }
+               output.close();
+               cout << "Generated " << number_rows << " rows with " << number_features << " features and " << number_classes << " classes in " << binary_filename << '\n';
+          }
+          else
+          {
+               ofstream x_output(x_filename, ios::binary), y_output(y_filename, ios::binary);
+               if (!x_output.is_open() || !y_output.is_open())
+               {
+                    cout << "Error opening " << x_filename << " or " << y_filename << " output file!";
+                    return -1;
+               }
+               vector<char> x_buffer(buffer_size), y_buffer(buffer_size);
+               uint64_t x_length = 0, y_length = 0;
+               for (uint64_t i = 0; i < number_rows; i++)
+               {
+                    uint64_t category = uid(mt);
+                    for (uint64_t j = 0; j < number_features; j++)
+                         append_number(x_output, x_buffer, x_length, centers[category - 1][j] + nd(mt), j + 1 < number_features ? ',' : '\n');
+                    if (y_length + 32 > y_buffer.size())
+                    {
+                         y_output.write(y_buffer.data(), y_length);
+                         y_length = 0;
+                    }
+                    y_length = to_chars(y_buffer.data() + y_length, y_buffer.data() + y_buffer.size(), category).ptr - y_buffer.data();
+                    y_buffer[y_length++] = '\n';
+               }
+               x_output.write(x_buffer.data(), x_length);
+               y_output.write(y_buffer.data(), y_length);
+               x_output.close();
+               y_output.close();
+               cout << "Generated " << number_rows << " rows with " << number_features << " features and " << number_classes << " classes in " << x_filename << " and " << y_filename << '\n';
+          }
+     }
+     catch (const exception &e)
+     {
+          cout << e.what() << '\n';
+          return -1;
+     }
+}
@@ -0,0 +1,407 @@
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief Accumulation of the deltas of the edges over the instances of a train set by several threads. The work is divided between a number of logical threads, each with its own copy of the layers, neurons and edges, and the part of each logical thread is a task of the shared thread pool, so an iteration does not create threads or allocate memory and the tasks run on the threads of the pool (At most number_threads of them at once). With reduction_mode::fast, logical thread t always sums the same contiguous part of the instances, and with reduction_mode::deterministic, the deltas of fixed chunks of instances are added by fixed pairwise trees, so the deltas only depend on the number of logical threads (Fast mode) or on nothing (Deterministic mode), and not on the threads of the pool which run the tasks.
+ *
+ * With a NUMA topology, the task of logical thread t pins the thread of the pool which runs it to the CPU of thread first_thread + t, and restores its affinity at the end, so the work of t always runs on the same node. The copy of the network of t is made by its task, so the copy is allocated on its node by the first-touch policy. The copy of the weights is refreshed from the shared edges once per iteration, so the forward and back propagation only read weights of the local node. The rows of t are copied once into a contiguous array on its node, and in deterministic mode the chunks of a group are assigned to the logical threads in turn instead of dynamically, so each logical thread always computes the same rows. The deltas do not change.
+ *
+ */
+class gradient_accumulator
+{
+
+public:
+    /**
+    * @brief Construct a new gradient accumulator::gradient accumulator object and copy the network for each logical thread.
+    *
+    * @param layers A vector containing all the layers of the network.
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network.
+    * @param _number_threads Number of logical threads.
+    * @param _mode The way the deltas of the threads are added.
+    * @param _topology The NUMA nodes which the threads are placed on (The threads are not pinned if it is null).
+    * @param _huge_pages If the copies of the weights and the rows of the threads should use transparent huge pages.
+    * @param _first_thread Number of the first thread in the topology, such as rank × number of threads with several workers.
+    */
+    gradient_accumulator(const vector<layer> &, const vector<neuron> &, const vector<edge> &, const uint64_t &, const reduction_mode &, const numa_topology * = nullptr, const bool & = false, const uint64_t & = 0);
+
+    gradient_accumulator(const gradient_accumulator &) = delete;
+    gradient_accumulator &operator=(const gradient_accumulator &) = delete;
+
+    /**
+    * @brief Member function to set the delta of each edge to the sum of the deltas of a range of instances, computed with the current weights.
+    *
+    * @param N The network.
+    * @param edges A vector containing all the edges of the network.
+    * @param x Features of the train set.
+    * @param classes The class of each instance of the train set (Starting from 1).
+    * @param begin The first instance.
+    * @param end The instance after the last one.
+    */
+    void accumulate(network &, vector<edge> &, vector<vector<double>> &, const vector<uint64_t> &, const uint64_t &, const uint64_t &);
+
+    /**
+    * @brief Member function to print the CPU and node of each thread and the bytes it reads from the other nodes in an iteration: the shared edges which it copies if they are on another node, and the part of its copy of the weights and of its rows which is on another node (Nothing is printed without a topology). accumulate() should be called first.
+    *
+    * @param out Output stream.
+    */
+    void print_placement(ostream &) const;
+
+private:
+    /**
+     * @brief The work which is dispatched to the threads.
+     *
+     */
+    enum class work_type
+    {
+        copy_network, // Each thread makes its own copy of the network (With a topology).
+        copy_rows,    // Each thread copies its rows into its contiguous array (With a topology).
+        compute       // Each thread computes the deltas of its instances.
+    };
+
+    /**
+    * @brief Member function to run the part of each logical thread of the current work as a task of the thread pool, pinned to its CPU with a topology, and wait until all of them are done.
+    *
+    */
+    void dispatch();
+
+    /**
+    * @brief Member function to do the part of a logical thread of the current work.
+    *
+    * @param t Number of the thread.
+    */
+    void work(const uint64_t &);
+
+    /**
+    * @brief Member function to compute the deltas of a range of instances with the copy of the network of a thread.
+    *
+    * @param t Number of the thread.
+    * @param begin The first instance.
+    * @param end The instance after the last one.
+    */
+    void compute(const uint64_t &, const uint64_t &, const uint64_t &);
+
+    /**
+    * @brief Member function to call a function for each row which a thread computes in an iteration, in the order they are computed (With a topology).
+    *
+    * @tparam F Type of the function.
+    * @param t Number of the thread.
+    * @param f The function, which is called with the number of the instance.
+    */
+    template <typename F>
+    void for_each_row(const uint64_t &, const F &) const;
+
+    /**
+     * @brief Number of threads.
+     *
+     */
+    uint64_t number_threads = 1;
+
+    /**
+     * @brief The way the deltas of the threads are added.
+     *
+     */
+    reduction_mode mode = reduction_mode::deterministic;
+
+    /**
+     * @brief Copies of the layers, neurons and edges of each thread.
+     *
+     */
+    vector<vector<layer>> local_layers;
+    vector<vector<neuron>> local_neurons;
+    vector<vector<edge>> local_edges;
+
+    /**
+     * @brief The deltas of the chunks of a group (Deterministic mode) or of the threads (Fast mode), stored one after the other.
+     *
+     */
+    vector<double> partial_deltas;
+
+    /**
+     * @brief Sum of the deltas of all the instances.
+     *
+     */
+    vector<double> total_deltas;
+
+    /**
+     * @brief The current work: the network, train set, and the instances of the threads (Fast mode) or of the chunks of the group (Deterministic mode).
+     *
+     */
+    network *current_network = nullptr;
+    vector<edge> *current_edges = nullptr;
+    vector<vector<double>> *current_x = nullptr;
+    const vector<uint64_t> *current_classes = nullptr;
+    uint64_t current_begin = 0, current_end = 0, current_chunks = 0;
+
+    /**
+     * @brief The next chunk of the group to be computed (Deterministic mode).
+     *
+     */
+    atomic<uint64_t> next_chunk{0};
+
+    /**
+     * @brief The NUMA nodes which the threads are placed on (Null if the threads are not pinned).
+     *
+     */
+    const numa_topology *topology = nullptr;
+
+    /**
+     * @brief If the copies of the weights and the rows of the threads should use transparent huge pages.
+     *
+     */
+    bool huge_pages = false;
+
+    /**
+     * @brief Number of the first thread in the topology.
+     *
+     */
+    uint64_t first_thread = 0;
+
+    /**
+     * @brief The CPUs which the threads of the pool could run on before a task pinned them.
+     *
+     */
+    vector<uint64_t> original_affinity;
+
+    /**
+     * @brief The network which the threads copy (With a topology).
+     *
+     */
+    const vector<layer> *source_layers = nullptr;
+    const vector<neuron> *source_neurons = nullptr;
+    const vector<edge> *source_edges = nullptr;
+
+    /**
+     * @brief The rows of each thread stored one after the other, including the bias unit (With a topology).
+     *
+     */
+    vector<vector<double>> local_rows;
+
+    /**
+     * @brief The next row of local_rows of each thread in the current iteration.
+     *
+     */
+    vector<uint64_t> local_cursor;
+
+    /**
+     * @brief The train set and the instances whose rows are in local_rows.
+     *
+     */
+    const vector<vector<double>> *rows_x = nullptr;
+    uint64_t rows_begin = 0, rows_end = 0;
+
+    /**
+     * @brief The current work.
+     *
+     */
+    work_type current_work = work_type::compute;
+};
+
+// ==============
+// Implementation
+// ==============
+
+gradient_accumulator::gradient_accumulator(const vector<layer> &layers, const vector<neuron> &neurons, const vector<edge> &edges, const uint64_t &_number_threads, const reduction_mode &_mode, const numa_topology *_topology, const bool &_huge_pages, const uint64_t &_first_thread)
+    : number_threads(max<uint64_t>(_number_threads, 1)), mode(_mode), local_layers(number_threads), local_neurons(number_threads), local_edges(number_threads), total_deltas(edges.size()), topology(_topology), huge_pages(_huge_pages), first_thread(_first_thread), local_rows(number_threads), local_cursor(number_threads)
+{
+    partial_deltas.resize((mode == reduction_mode::deterministic ? reduction_group : number_threads) * edges.size());
+    if (huge_pages)
+        advise_huge_pages(partial_deltas.data(), partial_deltas.size() * sizeof(double));
+    if (topology)
+        original_affinity = thread_affinity();
+
+    // Each logical thread copies the network after it is pinned, so the copy is on its node.
+    source_layers = &layers;
+    source_neurons = &neurons;
+    source_edges = &edges;
+    current_work = work_type::copy_network;
+    if (topology)
+        dispatch();
+    else
+    {
+        for (uint64_t t = 0; t < number_threads; t++)
+            work(t);
+    }
+    current_work = work_type::compute;
+}
+
+void gradient_accumulator::accumulate(network &N, vector<edge> &edges, vector<vector<double>> &x, const vector<uint64_t> &classes, const uint64_t &begin, const uint64_t &end)
+{
+    uint64_t number_edges = edges.size();
+    current_network = &N;
+    current_edges = &edges;
+    current_x = &x;
+    current_classes = &classes;
+    if (topology)
+    {
+        // The rows are copied in the first iteration, and again only if the instances change.
+        current_begin = begin;
+        current_end = end;
+        if (rows_x != &x || rows_begin != begin || rows_end != end)
+        {
+            current_work = work_type::copy_rows;
+            dispatch();
+            current_work = work_type::compute;
+            rows_x = &x;
+            rows_begin = begin;
+            rows_end = end;
+        }
+        fill(local_cursor.begin(), local_cursor.end(), 0);
+    }
+    if (mode == reduction_mode::fast)
+    {
+        // Thread t sums the deltas of its contiguous part of the instances, and the sums of the threads are added in order.
+        current_begin = begin;
+        current_end = end;
+        dispatch();
+        for (uint64_t i = 0; i < number_edges; i++)
+        {
+            double sum = 0;
+            for (uint64_t t = 0; t < number_threads; t++)
+                sum += partial_deltas[t * number_edges + i];
+            total_deltas[i] = sum;
+        }
+    }
+    else
+    {
+        // The instances are divided into chunks of reduction_chunk instances and the chunks into groups of reduction_group chunks. The threads take the chunks of a group in any order, the deltas of the chunks are added by a pairwise tree, and the sums of the groups are added in order.
+        fill(total_deltas.begin(), total_deltas.end(), 0);
+        for (uint64_t group_begin = begin; group_begin < end; group_begin += reduction_chunk * reduction_group)
+        {
+            current_begin = group_begin;
+            current_end = min(end, group_begin + reduction_chunk * reduction_group);
+            current_chunks = (current_end - current_begin + reduction_chunk - 1) / reduction_chunk;
+            next_chunk.store(0, memory_order_relaxed);
+            dispatch();
+            pairwise_reduce(partial_deltas.data(), current_chunks, number_edges);
+            for (uint64_t i = 0; i < number_edges; i++)
+                total_deltas[i] += partial_deltas[i];
+        }
+    }
+    N.set_deltas(edges, total_deltas);
+}
+
+void gradient_accumulator::dispatch()
+{
+    thread_pool::instance().parallel_for(0, number_threads, 1, [&](const uint64_t &begin, const uint64_t &end)
+                                         {
+                                             for (uint64_t t = begin; t < end; t++)
+                                             {
+                                                 if (topology)
+                                                     pin_thread(topology->cpu_of_thread(first_thread + t));
+                                                 work(t);
+                                                 if (topology)
+                                                     set_thread_affinity(original_affinity);
+                                             } });
+}
+
+void gradient_accumulator::work(const uint64_t &t)
+{
+    if (current_work == work_type::copy_network)
+    {
+        local_layers[t] = *source_layers;
+        local_neurons[t] = *source_neurons;
+        local_edges[t] = *source_edges;
+        if (huge_pages)
+            advise_huge_pages(local_edges[t].data(), local_edges[t].size() * sizeof(edge));
+        return;
+    }
+    if (current_work == work_type::copy_rows)
+    {
+        // The array is allocated and written by the thread, so its pages are on the node of the thread.
+        if (current_begin >= current_end)
+            return;
+        uint64_t width = (*current_x)[current_begin].size(), count = 0;
+        for_each_row(t, [&](const uint64_t &)
+                     { count++; });
+        vector<double> &rows = local_rows[t];
+        rows.assign(count * width, 0);
+        if (huge_pages)
+            advise_huge_pages(rows.data(), rows.size() * sizeof(double));
+        count = 0;
+        for_each_row(t, [&](const uint64_t &i)
+                     { copy((*current_x)[i].begin(), (*current_x)[i].end(), &rows[count++ * width]); });
+        return;
+    }
+
+    // The copy of the edges takes the current weights. The vectors have the same size, so nothing is allocated.
+    local_edges[t] = *current_edges;
+    uint64_t number_edges = current_edges->size();
+    if (mode == reduction_mode::fast)
+    {
+        uint64_t n = current_end - current_begin;
+        compute(t, current_begin + t * n / number_threads, current_begin + (t + 1) * n / number_threads);
+        for (uint64_t i = 0; i < number_edges; i++)
+            partial_deltas[t * number_edges + i] = local_edges[t][i].get_delta();
+        return;
+    }
+    // With a topology, the chunks are assigned in turn, so a thread always computes the rows in its array.
+    for (uint64_t c = topology ? t : next_chunk.fetch_add(1, memory_order_relaxed); c < current_chunks; c = topology ? c + number_threads : next_chunk.fetch_add(1, memory_order_relaxed))
+    {
+        uint64_t chunk_begin = current_begin + c * reduction_chunk;
+        compute(t, chunk_begin, min(current_end, chunk_begin + reduction_chunk));
+        for (uint64_t i = 0; i < number_edges; i++)
+            partial_deltas[c * number_edges + i] = local_edges[t][i].get_delta();
+    }
+}
+
+void gradient_accumulator::compute(const uint64_t &t, const uint64_t &begin, const uint64_t &end)
+{
+    for (edge &i : local_edges[t])
+        i.set_delta_zero();
+    for (uint64_t i = begin; i < end; i++)
+    {
+        const double *row = topology ? &local_rows[t][local_cursor[t]++ * (*current_x)[i].size()] : (*current_x)[i].data();
+        current_network->forward_propagation(local_layers[t], local_neurons[t], local_edges[t], row);
+        current_network->back_propagation(local_layers[t], local_neurons[t], local_edges[t], (*current_classes)[i]);
+    }
+}
+
+template <typename F>
+void gradient_accumulator::for_each_row(const uint64_t &t, const F &f) const
+{
+    if (mode == reduction_mode::fast)
+    {
+        uint64_t n = current_end - current_begin;
+        for (uint64_t i = current_begin + t * n / number_threads; i < current_begin + (t + 1) * n / number_threads; i++)
+            f(i);
+        return;
+    }
+    for (uint64_t group_begin = current_begin; group_begin < current_end; group_begin += reduction_chunk * reduction_group)
+    {
+        uint64_t group_end = min(current_end, group_begin + reduction_chunk * reduction_group);
+        for (uint64_t chunk_begin = group_begin + t * reduction_chunk; chunk_begin < group_end; chunk_begin += number_threads * reduction_chunk)
+        {
+            for (uint64_t i = chunk_begin; i < min(group_end, chunk_begin + reduction_chunk); i++)
+                f(i);
+        }
+    }
+}
+
+void gradient_accumulator::print_placement(ostream &out) const
+{
+    if (!topology)
+        return;
+    int64_t edges_node = current_edges ? node_of_address(current_edges->data()) : -1;
+    uint64_t edges_bytes = current_edges ? current_edges->size() * sizeof(edge) : 0;
+    uint64_t total = 0;
+    out << "thread\tcpu\tnode\tremote bytes per iteration (shared weights, own weights, rows)\n";
+    for (uint64_t t = 0; t < number_threads; t++)
+    {
+        uint64_t node = topology->node_of_thread(first_thread + t);
+        uint64_t shared = edges_node >= 0 && (uint64_t)edges_node != node ? edges_bytes : 0;
+        uint64_t own = bytes_on_other_nodes(local_edges[t].data(), local_edges[t].size() * sizeof(edge), node);
+        uint64_t rows = bytes_on_other_nodes(local_rows[t].data(), local_rows[t].size() * sizeof(double), node);
+        out << t << '\t' << topology->cpu_of_thread(first_thread + t) << '\t' << node << '\t' << shared << ", " << own << ", " << rows << '\n';
+        total += shared + own + rows;
+    }
+    out << "Bytes read from other nodes per iteration: " << total << " (" << topology->get_nodes() << " nodes)\n";
+}
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief Header of a request to the inference server. It is followed by rows * features feature values (double, without the bias unit) stored row by row. All the fields use the byte order of the host, since the server only accepts local connections.
+ *
+ */
+struct request_header
+{
+    uint32_t rows;     // Number of instances.
+    uint32_t features; // Number of features of each instance.
+};
+
+/**
+ * @brief Header of a response of the inference server. If the status is ok, it is followed by the predicted class of each instance (uint32_t) and then by the rows * outputs activations of the output layer (double) stored row by row.
+ *
+ */
+struct response_header
+{
+    uint32_t status;  // One of the response_status values.
+    uint32_t rows;    // Number of instances.
+    uint32_t outputs; // Number of neurons of the output layer.
+};
+
+/**
+ * @brief Status of a response. After a response with an error, the server closes the connection without reading the feature values of the request.
+ *
+ */
+enum response_status : uint32_t
+{
+    status_ok = 0,
+    status_wrong_features = 1, // The number of features does not match the model.
+    status_too_many_rows = 2   // The request has more rows than the maximum batch of the server.
+};
+
+/**
+ * @brief Reading exactly a number of bytes from a socket.
+ *
+ * @param fd The socket.
+ * @param data Buffer for the bytes.
+ * @param size Number of bytes.
+ * @return true If all the bytes were read.
+ * @return false If the connection was closed or failed.
+ */
+bool read_exact(const int &, void *, const uint64_t &);
+
+/**
+ * @brief Writing exactly a number of bytes to a socket.
+ *
+ * @param fd The socket.
+ * @param data The bytes.
+ * @param size Number of bytes.
+ * @return true If all the bytes were written.
+ * @return false If the connection was closed or failed.
+ */
+bool write_exact(const int &, const void *, const uint64_t &);
+
+/**
+ * @brief Filling the address of a Unix domain socket.
+ *
+ * @param path Path of the socket.
+ * @param address The address.
+ * @return true If the path fits in the address.
+ * @return false If the path is too long.
+ */
+bool unix_address(const string &, sockaddr_un &);
+
+/**
+ * @brief Percentile of a sample, which is sorted in place.
+ *
+ * @param sample The sample.
+ * @param p The percentile between 0 and 100.
+ * @return double The value of the percentile (0 if the sample is empty).
+ */
+double percentile(vector<double> &, const double &);
+
+// ==============
+// Implementation
+// ==============
+
+bool read_exact(const int &fd, void *data, const uint64_t &size)
+{
+    char *p = static_cast<char *>(data);
+    uint64_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = read(fd, p + done, size - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        done += n;
+    }
+    return true;
+}
+
+bool write_exact(const int &fd, const void *data, const uint64_t &size)
+{
+    const char *p = static_cast<const char *>(data);
+    uint64_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = send(fd, p + done, size - done, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        done += n;
+    }
+    return true;
+}
+
+bool unix_address(const string &path, sockaddr_un &address)
+{
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+        return false;
+    memcpy(address.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+double percentile(vector<double> &sample, const double &p)
+{
+    if (sample.empty())
+        return 0;
+    uint64_t k = min<uint64_t>(sample.size() - 1, sample.size() * p / 100);
+    nth_element(sample.begin(), sample.begin() + k, sample.end());
+    return sample[k];
+}
@@ -1,194 +1,351 @@
-#include <iostream>
-#include <vector>
-using namespace std;
-
-// =========
-// Interface
-// =========
-
-class layer
-{
-
-public:
-    /**
-    * @brief Construct a new layer::layer object 
-    * 
-    * @param _layer_number Layer number.
-    */
-    layer(const uint64_t &);
-
-    /**
-    * @brief Member function to obtain (but not modify) the layer number of the layer.
-    * 
-    * @return uint64_t Layer number.
-    */
-    uint64_t get_layer_number() const;
-
-    // Member function to obtain (but not modify) the layer number of a layer.
-    /**
-    * @brief Member function to generate the neurons of the layer.
-    * 
-    * @param number_nodes Vector containing the number of neurons in each layer.
-    * @param neurons The set of all neurons of the NN.
-    * @param start_ID ID of the first neuron for this layer (Or the number of neurons created before plus 1).
-    */
-    void gen_layer_neurons(const vector<uint64_t> &, vector<neuron> &, uint64_t &);
-
-    /**
-    * @brief Member function to obtain (but not modify) the neurons of the layer.
-    * 
-    * @return vector<uint64_t> The neurons of the layer.
-    */
-    vector<uint64_t> get_layer_neurons() const;
-
-    /**
-    * @brief  Member function to activate the layer.
-    * 
-    * @param neurons A vector containing all the neurons of the network.
-    * @param edges A vector containing all the edges of the network.
-    * @param x Feature values dataset.
-    */
-    void activate_layer(vector<neuron> &, vector<edge> &, vector<double> &);
-
-    /**
-    * @brief  Member function to calculate the errors for the layer. 
-    * 
-    * @param neurons A vector containing all the neurons of the network.
-    * @param edges A vector containing all the edges of the network.
-    * @param y The output values of the dataset.
-    * @param number_layers Number of layers of the NN.
-    */
-    void error_layer(vector<neuron> &, vector<edge> &, vector<double> &, uint64_t &);
-
-private:
-    /**
-     * @brief The number of the layer.
-     * 
-     */
-    uint64_t layer_number = 0;
-
-    /**
-     * @brief Vector of neurons IDs of the layer
-     * 
-     */
-    vector<uint64_t> layer_neurons;
-};
-
-/**
- * @brief Overloaded binary operator << to easily print out a layer a stream.
- * 
- * @param out Output stream.
- * @param m The layer.
- * @return ostream& The layer member variables.
- */
-ostream &operator<<(ostream &, const layer &);
-
-/**
- * @brief Sigmoid function which is equal to y(x) = 1 / (1 + exp(-x)).
- * 
- * @tparam T Template.
- * @param x Input of the function.
- * @return T Output of the function.
- */
-template <typename T>
-T sigmoid(const T &);
-
-// ==============
-// Implementation
-// ==============
-
-layer::layer(const uint64_t &_layer_number)
-    : layer_number(_layer_number)
-{
-}
-
-uint64_t layer::get_layer_number() const
-{
-    return layer_number;
-}
-
-void layer::gen_layer_neurons(const vector<uint64_t> &number_nodes, vector<neuron> &neurons, uint64_t &start_ID)
-{
-
-    for (uint64_t j = 0; j <= number_nodes[layer_number - 1]; j++)
-    {
-        if ((j == 0) && (layer_number == number_nodes.size()))
-            continue;
-        start_ID++;
-        neuron n(start_ID, layer_number, j);
-        neurons.push_back(n);
-        layer_neurons.push_back(start_ID);
-    }
-}
-
-vector<uint64_t> layer::get_layer_neurons() const
-{
-    return layer_neurons;
-}
-
-void layer::activate_layer(vector<neuron> &neurons, vector<edge> &edges, vector<double> &x)
-{
-    if (layer_number == 1)
-    {
-        for (neuron &i : neurons)
-        {
-            if (i.layer == layer_number)
-            {
-                i.activation = x[i.number]; // Setting activation of the first layer neurons equal to the features values in the dataset.
-            }
-        }
-    }
-
-    else
-    {
-
-        for (neuron &i : neurons)
-        {
-            if (i.layer == layer_number)
-            {
-                if (i.number != 0)
-                    i.activation = sigmoid(i.activate_neuron(neurons, edges)); // Setting activation of the layer using activate_neuron() function for each neuron of the layer.
-                else
-                    i.activation = 1;
-            }
-        }
-    }
-}
-
-void layer::error_layer(vector<neuron> &neurons, vector<edge> &edges, vector<double> &y, uint64_t &number_layers)
-{
-    if (layer_number == number_layers)
-    {
-        for (neuron &i : neurons)
-        {
-            if (i.layer == layer_number)
-            {
-                i.error = i.activation - y[i.number - 1]; // Setting error of the last layer using the output values of the dataset.
-            }
-        }
-    }
-    else
-    {
-        for (neuron &i : neurons)
-        {
-            if (i.layer == layer_number)
-            {
-                if (i.number != 0)
-                    i.error = i.error_neuron(neurons, edges); // Setting error of the layer using error_neuron() function for each neuron of the layer.
-            }
-        }
-    }
-}
-
-ostream &
-operator<<(ostream &out, const layer &m)
-{
-    out << "\n layer number: " << m.get_layer_number();
-    return out;
-}
-
-template <typename T>
-T sigmoid(const T &x)
-{
-    return 1 / (1 + exp(-x));
+#include <iostream>
+#include <vector>
+#include <limits>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+class layer
+{
+
+public:
+    /**
+    * @brief Construct a new layer::layer object 
+    * 
+    * @param _layer_number Layer number.
+    * @param _activation_function Activation function of the neurons of the layer (Not used for the input layer).
+    */
+    layer(const uint64_t &, const activation_type & = activation_type::sigmoid);
+
+    /**
+    * @brief Member function to obtain (but not modify) the layer number of the layer.
+    * 
+    * @return uint64_t Layer number.
+    */
+    uint64_t get_layer_number() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the activation function of the layer.
+    * 
+    * @return activation_type Activation function of the layer.
+    */
+    activation_type get_activation_function() const;
+
+    // Member function to obtain (but not modify) the layer number of a layer.
+    /**
+    * @brief Member function to generate the neurons of the layer.
+    * 
+    * @param number_nodes Vector containing the number of neurons in each layer.
+    * @param neurons The set of all neurons of the NN.
+    * @param start_ID ID of the first neuron for this layer (Or the number of neurons created before plus 1).
+    */
+    void gen_layer_neurons(const vector<uint64_t> &, vector<neuron> &, uint64_t &);
+
+    /**
+    * @brief Member function to obtain (but not modify) the neurons of the layer.
+    * 
+    * @return const vector<uint64_t>& The neurons of the layer.
+    */
+    const vector<uint64_t> &get_layer_neurons() const;
+
+    /**
+    * @brief  Member function to activate the layer.
+    * 
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network.
+    * @param x Feature values dataset.
+    */
+    void activate_layer(vector<neuron> &, vector<edge> &, vector<double> &);
+
+    /**
+    * @brief Member function to activate the neurons of the layer from the feature values of an instance stored in an array, such as a row of a contiguous block of rows.
+    * 
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network.
+    * @param x Feature values of the instance, starting with the bias unit.
+    */
+    void activate_layer(vector<neuron> &, vector<edge> &, const double *);
+
+    /**
+    * @brief  Member function to activate the first hidden layer (Layer 2) from the sparse features of an instance. The weighted sum of each neuron only adds the weights of the bias unit and of the non-zero features, which are found directly since the edges of the first layer are stored neuron by neuron in the order of the features. The neurons of the input layer are not used.
+    * 
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network.
+    * @param features The non-zero features of the instance (Starting from 1).
+    * @param values The values of these features.
+    * @param count Number of non-zero features.
+    * @param number_features Number of neurons of the input layer (Except the bias unit).
+    */
+    void activate_sparse_layer(vector<neuron> &, const vector<edge> &, const uint64_t *, const double *, const uint64_t &, const uint64_t &);
+
+    /**
+    * @brief  Member function to calculate the errors for the layer. The error of the output layer is the activation minus 1 for the neuron of the class and minus 0 for the others, which is the gradient of the cross-entropy for both sigmoid and softmax outputs, so the one-hot output vector is never created.
+    * 
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network.
+    * @param label The class of the instance (Starting from 1).
+    * @param number_layers Number of layers of the NN.
+    */
+    void error_layer(vector<neuron> &, vector<edge> &, const uint64_t &, uint64_t &);
+
+private:
+    /**
+    * @brief Member function to activate the neurons of a hidden or output layer. The activation policy is chosen at compile time, so the loop over the neurons is specialized for each activation function.
+    * 
+    * @tparam Activation Activation policy of the layer.
+    * @tparam WeightedSum Function which computes the weighted sum of the inputs of a neuron.
+    * @param neurons A vector containing all the neurons of the network.
+    * @param weighted_sum The weighted sum of a neuron, such as over all the edges of its input layer or only over the non-zero features.
+    */
+    template <typename Activation, typename WeightedSum>
+    void activate_neurons(vector<neuron> &, const WeightedSum &);
+
+    /**
+    * @brief Member function to calculate the errors of the neurons of a hidden layer.
+    * 
+    * @tparam Activation Activation policy of the layer.
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network.
+    */
+    template <typename Activation>
+    void error_neurons(vector<neuron> &, vector<edge> &);
+
+    /**
+     * @brief The number of the layer.
+     * 
+     */
+    uint64_t layer_number = 0;
+
+    /**
+     * @brief Activation function of the neurons of the layer.
+     * 
+     */
+    activation_type activation_function = activation_type::sigmoid;
+
+    /**
+     * @brief Vector of neurons IDs of the layer. The neurons of the network are stored in order of their IDs, so the neuron with ID i is neurons[i - 1].
+     * 
+     */
+    vector<uint64_t> layer_neurons;
+};
+
+/**
+ * @brief Overloaded binary operator << to easily print out a layer a stream.
+ * 
+ * @param out Output stream.
+ * @param m The layer.
+ * @return ostream& The layer member variables.
+ */
+ostream &operator<<(ostream &, const layer &);
+
+// ==============
+// Implementation
+// ==============
+
+layer::layer(const uint64_t &_layer_number, const activation_type &_activation_function)
+    : layer_number(_layer_number), activation_function(_activation_function)
+{
+}
+
+uint64_t layer::get_layer_number() const
+{
+    return layer_number;
+}
+
+activation_type layer::get_activation_function() const
+{
+    return activation_function;
+}
+
+void layer::gen_layer_neurons(const vector<uint64_t> &number_nodes, vector<neuron> &neurons, uint64_t &start_ID)
+{
+
+    for (uint64_t j = 0; j <= number_nodes[layer_number - 1]; j++)
+    {
+        if ((j == 0) && (layer_number == number_nodes.size()))
+            continue;
+        start_ID++;
+        neuron n(start_ID, layer_number, j);
+        neurons.push_back(n);
+        layer_neurons.push_back(start_ID);
+    }
+}
+
+const vector<uint64_t> &layer::get_layer_neurons() const
+{
+    return layer_neurons;
+}
+
+void layer::activate_layer(vector<neuron> &neurons, vector<edge> &edges, vector<double> &x)
+{
+    activate_layer(neurons, edges, x.data());
+}
+
+void layer::activate_layer(vector<neuron> &neurons, vector<edge> &edges, const double *x)
+{
+    PROFILE_SCOPE(forward);
+    scoped_trace trace_scope("forward layer", "layer", layer_number);
+    if (layer_number == 1)
+    {
+        for (const uint64_t &ID : layer_neurons)
+        {
+            neuron &i = neurons[ID - 1];
+            i.activation = x[i.number]; // Setting activation of the first layer neurons equal to the features values in the dataset.
+        }
+    }
+
+    else
+    {
+        // Choosing the specialized loop once per layer instead of once per neuron.
+        auto weighted_sum = [&](neuron &i)
+        { return i.activate_neuron(neurons, edges); };
+        switch (activation_function)
+        {
+        case activation_type::sigmoid:
+            activate_neurons<sigmoid_activation>(neurons, weighted_sum);
+            break;
+        case activation_type::tanh:
+            activate_neurons<tanh_activation>(neurons, weighted_sum);
+            break;
+        case activation_type::relu:
+            activate_neurons<relu_activation>(neurons, weighted_sum);
+            break;
+        case activation_type::leaky_relu:
+            activate_neurons<leaky_relu_activation>(neurons, weighted_sum);
+            break;
+        case activation_type::softmax:
+            activate_neurons<softmax_activation>(neurons, weighted_sum);
+            break;
+        }
+    }
+}
+
+void layer::activate_sparse_layer(vector<neuron> &neurons, const vector<edge> &edges, const uint64_t *features, const double *values, const uint64_t &count, const uint64_t &number_features)
+{
+    PROFILE_SCOPE(forward);
+    scoped_trace trace_scope("forward sparse layer", "layer", layer_number);
+    auto weighted_sum = [&](neuron &i)
+    {
+        // The input edges of neuron number j of layer 2 are edges (j - 1)(number_features + 1) + k for the features k = 0, 1, ..., number_features, where feature 0 is the bias unit.
+        const edge *w = &edges[(i.number - 1) * (number_features + 1)];
+        double sum = w[0].get_weight();
+        for (uint64_t k = 0; k < count; k++)
+            sum += w[features[k]].get_weight() * values[k];
+        return sum;
+    };
+    switch (activation_function)
+    {
+    case activation_type::sigmoid:
+        activate_neurons<sigmoid_activation>(neurons, weighted_sum);
+        break;
+    case activation_type::tanh:
+        activate_neurons<tanh_activation>(neurons, weighted_sum);
+        break;
+    case activation_type::relu:
+        activate_neurons<relu_activation>(neurons, weighted_sum);
+        break;
+    case activation_type::leaky_relu:
+        activate_neurons<leaky_relu_activation>(neurons, weighted_sum);
+        break;
+    case activation_type::softmax:
+        activate_neurons<softmax_activation>(neurons, weighted_sum);
+        break;
+    }
+}
+
+void layer::error_layer(vector<neuron> &neurons, vector<edge> &edges, const uint64_t &label, uint64_t &number_layers)
+{
+    PROFILE_SCOPE(error);
+    scoped_trace trace_scope("error layer", "layer", layer_number);
+    if (layer_number == number_layers)
+    {
+        for (const uint64_t &ID : layer_neurons)
+        {
+            neuron &i = neurons[ID - 1];
+            i.error = i.activation - (i.number == label ? 1 : 0); // Setting error of the last layer using the class of the instance.
+        }
+    }
+    else
+    {
+        switch (activation_function)
+        {
+        case activation_type::sigmoid:
+            error_neurons<sigmoid_activation>(neurons, edges);
+            break;
+        case activation_type::tanh:
+            error_neurons<tanh_activation>(neurons, edges);
+            break;
+        case activation_type::relu:
+            error_neurons<relu_activation>(neurons, edges);
+            break;
+        case activation_type::leaky_relu:
+            error_neurons<leaky_relu_activation>(neurons, edges);
+            break;
+        case activation_type::softmax:
+            error_neurons<softmax_activation>(neurons, edges);
+            break;
+        }
+    }
+}
+
+template <typename Activation, typename WeightedSum>
+void layer::activate_neurons(vector<neuron> &neurons, const WeightedSum &weighted_sum)
+{
+    double max_input = -numeric_limits<double>::infinity(); // Maximum weighted sum of the layer, only used by softmax.
+    for (const uint64_t &ID : layer_neurons)
+    {
+        neuron &i = neurons[ID - 1];
+        if (i.number != 0)
+        {
+            if constexpr (Activation::normalizes_layer)
+            {
+                i.activation = weighted_sum(i); // Saving the weighted sum of the neuron until the whole layer is computed.
+                max_input = max(max_input, i.activation);
+            }
+            else
+                i.activation = Activation::activate(weighted_sum(i)); // Setting activation of the layer using the weighted sum of each neuron of the layer.
+        }
+        else
+            i.activation = 1;
+    }
+
+    if constexpr (Activation::normalizes_layer)
+    {
+        double sum = 0;
+        for (const uint64_t &ID : layer_neurons)
+        {
+            neuron &i = neurons[ID - 1];
+            if (i.number != 0)
+            {
+                i.activation = Activation::activate(i.activation - max_input);
+                sum += i.activation;
+            }
+        }
+        for (const uint64_t &ID : layer_neurons)
+        {
+            neuron &i = neurons[ID - 1];
+            if (i.number != 0)
+                i.activation /= sum;
+        }
+    }
+}
+
+template <typename Activation>
+void layer::error_neurons(vector<neuron> &neurons, vector<edge> &edges)
+{
+    for (const uint64_t &ID : layer_neurons)
+    {
+        neuron &i = neurons[ID - 1];
+        if (i.number != 0)
+            i.error = i.error_neuron<Activation>(neurons, edges); // Setting error of the layer using error_neuron() function for each neuron of the layer.
+    }
+}
+
+ostream &
+operator<<(ostream &out, const layer &m)
+{
+    out << "\n layer number: " << m.get_layer_number();
+    return out;
 }
\ No newline at end of file
@@ -0,0 +1,139 @@
+/**
+ * @file loadgen.cpp
+ * @brief Load generator for the inference server.
+ *
+ * Opens a number of connections to the server and sends requests with random feature values from each of them as fast as the responses arrive. At the end, the throughput and the percentiles of the latency seen by the clients are printed.
+ *
+ * Usage: loadgen [--socket /tmp/nn.sock] [--connections 8] [--requests 10000] [--rows 1] [--features 13] [--seed 0]
+ *
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <random>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include "inference_protocol.hpp"
+
+using namespace std;
+
+/**
+ * @brief Sending requests on one connection and saving their latencies.
+ *
+ * @param socket_path Path of the socket of the server.
+ * @param number_requests Number of requests.
+ * @param rows Number of instances of each request.
+ * @param features Number of features of each instance.
+ * @param seed Seed of the random feature values.
+ * @param latencies_us Latency of each request in microseconds.
+ * @param errors Number of requests which failed.
+ */
+void run_connection(const string &socket_path, const uint64_t number_requests, const uint64_t rows, const uint64_t features, const uint64_t seed, vector<double> &latencies_us, atomic<uint64_t> &errors)
+{
+     sockaddr_un address;
+     int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+     if (fd < 0 || !unix_address(socket_path, address) || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+     {
+          errors += number_requests;
+          if (fd >= 0)
+               close(fd);
+          return;
+     }
+     mt19937_64 mt(seed);
+     normal_distribution<double> nd(0, 1);
+     vector<double> x(rows * features), y;
+     vector<uint32_t> classes(rows);
+     request_header request = {(uint32_t)rows, (uint32_t)features};
+     latencies_us.reserve(number_requests);
+     for (uint64_t i = 0; i < number_requests; i++)
+     {
+          for (double &j : x)
+               j = nd(mt);
+          chrono::steady_clock::time_point start = chrono::steady_clock::now();
+          response_header response;
+          if (!write_exact(fd, &request, sizeof(request)) || !write_exact(fd, x.data(), x.size() * sizeof(double)) || !read_exact(fd, &response, sizeof(response)))
+          {
+               errors += number_requests - i;
+               break;
+          }
+          if (response.status != status_ok) // The server closes the connection after an error.
+          {
+               errors += number_requests - i;
+               break;
+          }
+          y.resize((uint64_t)response.rows * response.outputs);
+          if (!read_exact(fd, classes.data(), response.rows * sizeof(uint32_t)) || !read_exact(fd, y.data(), y.size() * sizeof(double)))
+          {
+               errors += number_requests - i;
+               break;
+          }
+          latencies_us.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+     }
+     close(fd);
+}
+
+int main(int argc, char *argv[])
+{
+     try
+     {
+          // Reading the command line options.
+          string socket_path = "/tmp/nn.sock";
+          uint64_t number_connections = 8;
+          uint64_t number_requests = 10000;
+          uint64_t rows = 1;
+          uint64_t features = 13;
+          uint64_t seed = 0;
+          for (int i = 1; i < argc; i++)
+          {
+               string option = argv[i];
+               if (i + 1 >= argc)
+                    option = "";
+               if (option == "--socket")
+                    socket_path = argv[++i];
+               else if (option == "--connections")
+                    number_connections = max<uint64_t>(stoull(argv[++i]), 1);
+               else if (option == "--requests")
+                    number_requests = stoull(argv[++i]);
+               else if (option == "--rows")
+                    rows = max<uint64_t>(stoull(argv[++i]), 1);
+               else if (option == "--features")
+                    features = stoull(argv[++i]);
+               else if (option == "--seed")
+                    seed = stoull(argv[++i]);
+               else
+               {
+                    cout << "Usage: " << argv[0] << " [--socket /tmp/nn.sock] [--connections 8] [--requests 10000] [--rows 1] [--features 13] [--seed 0]\n";
+                    return -1;
+               }
+          }
+
+          // The requests are divided between the connections.
+          vector<vector<double>> latencies_us(number_connections);
+          atomic<uint64_t> errors{0};
+          vector<thread> connections;
+          chrono::steady_clock::time_point start = chrono::steady_clock::now();
+          for (uint64_t i = 0; i < number_connections; i++)
+          {
+               uint64_t share = number_requests / number_connections + (i < number_requests % number_connections ? 1 : 0);
+               connections.emplace_back(run_connection, cref(socket_path), share, rows, features, seed + i, ref(latencies_us[i]), ref(errors));
+          }
+          for (thread &i : connections)
+               i.join();
+          double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+          vector<double> all_latencies;
+          for (const vector<double> &i : latencies_us)
+               all_latencies.insert(all_latencies.end(), i.begin(), i.end());
+          uint64_t completed = all_latencies.size();
+          cout << "Completed " << completed << " requests (" << errors << " errors) on " << number_connections << " connections in " << seconds << " s\n";
+          cout << "Throughput: " << completed / seconds << " requests/s, " << completed * rows / seconds << " rows/s\n";
+          cout << "Latency p50: " << percentile(all_latencies, 50) << " us, p99: " << percentile(all_latencies, 99) << " us, p99.9: " << percentile(all_latencies, 99.9) << " us, max: " << percentile(all_latencies, 100) << " us\n";
+          return errors > 0 ? 1 : 0;
+     }
+     catch (const exception &e)
+     {
+          return -1;
+     }
+}
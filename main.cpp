@@ -1,297 +1,843 @@
-/**
- * @file main.cpp
- * @author Rana Shariat (rana.shariat@gmail.com)
- * @brief Neural network (NN) implementation using back propagation algorithm.
- * @version 0.1
- * @date 2021-12-24
- * 
- * @copyright Copyright (c) 2021
- * 
- */
-
-#include <iostream>
-#include <stdexcept>
-#include <vector>
-#include <random>
-#include <cmath>
-#include <fstream>
-#include "edge.hpp"
-#include "neuron.hpp"
-#include "layer.hpp"
-#include "network.hpp"
-#include "read_x.hpp"
-#include "read_y.hpp"
-#include "configuration.hpp"
-
-using namespace std;
-
-/**
- * @brief Find an element in a vector and return the index number.
- * 
- * @tparam T Template.
- * @param a The vector in which the element is being searched.
- * @param b The element we want to find.
- * @return uint64_t The index number of b in a.
- */
-template <typename T>
-uint64_t find_in_vec(const vector<T> a, const T b)
-{
-     for (uint64_t i = 0; i < a.size(); i++)
-     {
-          if (b == a[i])
-               return i;
-     }
-     return 0; // Just written for removing the warning. This line will never be executed in this problem.
-}
-
-/**
- * @brief Calculating the accuracy by comparing the predicted and actual values.
- * 
- * @param a The first vector (actual or predicted values)
- * @param b The second vector (predicted or actual values)
- * @return double The average number of elements which have the same value in both vectors.
- */
-double accuracy(vector<uint64_t> a, vector<uint64_t> b)
-{
-     uint64_t true_prediction = 0;
-     for (uint64_t i = 0; i < a.size(); i++)
-     {
-          if (a[i] == b[i])
-               true_prediction++;
-     }
-     return (double)(true_prediction) / (double)a.size();
-}
-
-/**
- * @brief printing the elements of a vector.
- * 
- * @tparam T Template.
- * @param v Vector to be printed.
- */
-template <typename T>
-void print_elements(const vector<T> &v)
-{
-     for (const T &i : v)
-          cout << i << ' ';
-     cout << '\n';
-}
-
-/**
- * @brief Average of a vector's elements.
- * 
- * @tparam T Template.
- * @param v A vector.
- * @return T Average of elements.
- */
-template <typename T>
-T vec_average(const vector<T> &v)
-{
-     T sum = 0;
-     for (const T &i : v)
-          sum = sum + i;
-     return sum / (double)v.size();
-}
-
-int main()
-{
-     try
-     {
-          // Reading file x.csv which contains features dataset.
-          string filename = "x.csv";
-          read_x x(filename);
-
-          // Reading file y.csv which contains output (classes) dataset.
-          filename = "y.csv";
-          read_y classes(filename);
-
-          // To check if both x.csv and y.csv have the same number of instances
-          if (x.get_rows() != classes.get_rows())
-          {
-               cout << "Error in" << filename << ": Number of rows is not the same as features dataset file!";
-               return -1;
-          }
-
-          uint64_t number_instances = classes.get_rows();          // Number of instances in the dataset.
-          uint64_t number_features = x.get_cols();                 // Number of features in x.csv.
-          uint64_t number_classes = classes.find_number_classes(); // Number of different classes in the dataset.
-
-          // Creating output vector proper for neural vector. Instead of class number, the output should be a vector with size equal to number of classes. The ith element, where i is the class number, should be 1 and the rest 0.
-          vector<vector<double>> y(number_instances, vector<double>(number_classes, 0));
-
-          for (uint64_t i = 0; i < number_instances; i++)
-          {
-               y[i][classes.get_values()[i] - 1] = 1;
-          }
-
-          // Reading layers.csv which contains number of neurons in each layer (except the input and output layer)
-          filename = "layers.csv";
-          read_y number_neurons(filename);
-
-          // Reading parameters from parameters.csv which contains the paramters of the model.
-          filename = "parameters.csv";
-          configuration parameters(filename);
-
-          // Adding the number of features (number of neurons for the first layer), the number of classes (the number of neurons for the last layer), and the number of neurons of the hidden layers to the vector number_neurons_layer which shows the number of neurons per layer of the network.
-          vector<uint64_t> number_neurons_layer = number_neurons.get_values();
-          number_neurons_layer.insert(number_neurons_layer.begin(), number_features);
-          number_neurons_layer.insert(number_neurons_layer.end(), number_classes);
-
-          // Number of layers in the defined architecture.
-          uint64_t number_layers = number_neurons_layer.size();
-
-          // A vector for saving the accuracy of each trained model using NN.
-          vector<double> cv_accuracy(parameters.get_num_cv());
-
-          // Cross validation with num_cv iterations.
-          for (uint64_t count = 0; count < parameters.get_num_cv(); count++)
-          {
-               // Creating train and test sets by splitting data randomly based on the train percentage.
-               random_device rd;
-               mt19937 mt(rd());
-               vector<double> random_numbers(number_instances);                                                              // Creating random number for splitting data.
-               vector<double> random_numbers_sorted(number_instances);                                                       // A vector of the sorted random numbers.
-               vector<vector<double>> train_x(number_instances * parameters.get_train_percantage() / 100);                   // Train set of x (features).
-               vector<vector<double>> test_x(number_instances - number_instances * parameters.get_train_percantage() / 100); // Test set of x (features).
-               vector<vector<double>> train_y(number_instances * parameters.get_train_percantage() / 100);                   // Train set of y (outputs).
-               vector<vector<double>> test_y(number_instances - number_instances * parameters.get_train_percantage() / 100); //Test set of y (outputs).
-               vector<uint64_t> train_classes(number_instances * parameters.get_train_percantage() / 100);                   // Classes of the train set.
-               vector<uint64_t> test_classes(number_instances - number_instances * parameters.get_train_percantage() / 100); // Classes of the test set.
-
-               // Creating random numbers.
-               for (uint64_t i = 0; i < number_instances; i++)
-               {
-                    uniform_real_distribution<double> urd(0, 1);
-                    random_numbers[i] = urd(mt);
-               }
-
-               for (uint64_t i = 0; i < number_instances; i++)
-               {
-                    random_numbers_sorted[i] = random_numbers[i];
-               }
-
-               // Sorting random numbers and choosing the first train_percentage as train set.
-               sort(random_numbers_sorted.begin(), random_numbers_sorted.end());
-
-               // Train set.
-               uint64_t j = 0;
-               for (uint64_t i = 0; i < number_instances * parameters.get_train_percantage() / 100; i++)
-               {
-                    train_x[j] = x.get_values()[find_in_vec(random_numbers, random_numbers_sorted[i])];
-                    train_y[j] = y[find_in_vec(random_numbers, random_numbers_sorted[i])];
-                    train_classes[j] = classes.get_values()[find_in_vec(random_numbers, random_numbers_sorted[i])];
-                    j++;
-               }
-
-               // Test set.
-               j = 0;
-               for (uint64_t i = number_instances * parameters.get_train_percantage() / 100; i < number_instances; i++)
-               {
-                    test_x[j] = x.get_values()[find_in_vec(random_numbers, random_numbers_sorted[i])];
-                    test_y[j] = y[find_in_vec(random_numbers, random_numbers_sorted[i])];
-                    test_classes[j] = classes.get_values()[find_in_vec(random_numbers, random_numbers_sorted[i])];
-                    j++;
-               }
-
-               uint64_t ID = 0;        // Counter for edge or neuron ID.
-               vector<layer> layers;   // Vector which includes the layers of NN.
-               vector<neuron> neurons; // Vector which includes the neurons of NN.
-
-               // Generating layers and their neurons.
-               for (uint64_t i = 1; i <= number_neurons_layer.size(); i++)
-               {
-                    layer l(i);
-                    l.gen_layer_neurons(number_neurons_layer, neurons, ID);
-                    layers.push_back(l);
-               }
-
-               ID = 0;
-               vector<edge> edges; //vector of all edges of NN.
-
-               // Generating input edges for each neuron.
-               for (neuron &i : neurons)
-               {
-                    i.gen_input_edges(number_neurons_layer, edges, ID);
-               }
-
-               // Generating output edges for each neuron.
-               for (neuron &i : neurons)
-               {
-                    i.gen_output_edges(number_neurons_layer, edges);
-               }
-
-               // Generating the network.
-               network N(neurons.size(), edges.size());
-
-               // Training the network using train set for num_iteration iterations.
-               for (uint64_t k = 0; k < parameters.get_num_iteration(); k++)
-               {
-                    // Setting delta equal to zero at the beginning of each iteration
-                    for (edge &i : edges)
-                         i.set_delta_zero();
-
-                    // Train using instance number t.
-                    for (uint64_t t = 0; t < number_instances * parameters.get_train_percantage() / 100; t++)
-                    {
-
-                         // Activate layers of the network.
-                         for (layer &i : layers)
-                         {
-                              i.activate_layer(neurons, edges, train_x[t]);
-                         }
-                         // Find the error for layers of NN.
-                         for (uint64_t i = number_layers; i > 1; i--)
-                         {
-                              layers[i - 1].error_layer(neurons, edges, train_y[t], number_layers);
-                         }
-
-                         // Update delta for each edge.
-                         N.delta_update(neurons, edges);
-                    }
-                    // Update gradient of each edge.
-                    N.gradient_update(edges, number_instances * parameters.get_train_percantage() / 100, parameters.get_lambda());
-
-                    // Run gradient descent algorithm to update the weights of the edges.
-                    N.gradient_descent(edges, parameters.get_learning_rate());
-               }
-
-               // Test the trained model on the test set.
-               vector<uint64_t> predicted_classes(number_instances - number_instances * parameters.get_train_percantage() / 100); //Vector containing the predicted classes.
-
-               for (uint64_t t = 0; t < number_instances - number_instances * parameters.get_train_percantage() / 100; t++)
-               {
-                    // Activate layers of the network
-                    for (layer &i : layers)
-                    {
-                         i.activate_layer(neurons, edges, test_x[t]);
-                    }
-
-                    // Find category based on the neuron with maximum activation in the last layer.
-                    double max_activation = (neuron(0, number_layers, 1).find_neuron(neurons)).get_activation();
-                    uint64_t category = 1;
-                    // Update the category of the instance.
-                    for (uint64_t i = 2; i <= number_classes; i++)
-                    {
-                         if (((neuron(0, number_layers, i).find_neuron(neurons)).get_activation()) > max_activation)
-                         {
-                              max_activation = ((neuron(0, number_layers, i).find_neuron(neurons)).get_activation());
-                              category = i;
-                         }
-                    }
-                    predicted_classes[t] = category;
-               }
-               // Calculate the accuracy of the predicted classes for the test set.
-               cv_accuracy[count] = accuracy(predicted_classes, test_classes);
-               cout << "\nTest set " << count + 1 << "\n\nPrediction accuracy: " << cv_accuracy[count] << "\n";
-               cout << "\nPreticted classes for the test set:\n";
-               print_elements(predicted_classes);
-               cout << "\nActual classes for the test set:\n";
-               print_elements(test_classes);
-          }
-          // Average accuracy of all trained models.
-          cout << "\nAverage accuracy: " << vec_average(cv_accuracy);
-     }
-     catch (const exception &e)
-     {
-          return -1;
-     }
+/**
+ * @file main.cpp
+ * @author Rana Shariat (rana.shariat@gmail.com)
+ * @brief Neural network (NN) implementation using back propagation algorithm.
+ * @version 0.1
+ * @date 2021-12-24
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <fstream>
+#include <algorithm>
+#include <optional>
+#include <memory>
+#include <chrono>
+#include <numeric>
+#ifdef __linux__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include "profiler.hpp"
+#include "alloc_tracker.hpp"
+#include "trace.hpp"
+#include "activation.hpp"
+#include "thread_pool.hpp"
+#include "counter_rng.hpp"
+#include "edge.hpp"
+#include "neuron.hpp"
+#include "layer.hpp"
+#include "transport.hpp"
+#include "reduction.hpp"
+#include "gemm.hpp"
+#include "network.hpp"
+#include "numa.hpp"
+#include "batch_loader.hpp"
+#include "gradient_accumulator.hpp"
+#include "gemm_accumulator.hpp"
+#include "standardization.hpp"
+#include "read_x.hpp"
+#include "read_y.hpp"
+#include "sparse_matrix.hpp"
+#include "read_libsvm.hpp"
+#include "read_hashed_x.hpp"
+#include "configuration.hpp"
+#include "model.hpp"
+#include "checkpoint.hpp"
+#include "perf_counters.hpp"
+
+using namespace std;
+
+/**
+ * @brief Calculating the accuracy by comparing the predicted and actual values.
+ * 
+ * @param a The first vector (actual or predicted values)
+ * @param b The second vector (predicted or actual values)
+ * @return double The average number of elements which have the same value in both vectors.
+ */
+double accuracy(const vector<uint64_t> &a, const vector<uint64_t> &b)
+{
+     uint64_t true_prediction = 0;
+     for (uint64_t i = 0; i < a.size(); i++)
+     {
+          if (a[i] == b[i])
+               true_prediction++;
+     }
+     return (double)(true_prediction) / (double)a.size();
+}
+
+/**
+ * @brief printing the elements of a vector.
+ * 
+ * @tparam T Template.
+ * @param v Vector to be printed.
+ */
+template <typename T>
+void print_elements(const vector<T> &v)
+{
+     for (const T &i : v)
+          cout << i << ' ';
+     cout << '\n';
+}
+
+/**
+ * @brief Replacing class numbers by the labels of the classes.
+ * 
+ * @param classes The class numbers (Starting from 1).
+ * @param labels The label of each class number.
+ * @return vector<int64_t> The labels.
+ */
+vector<int64_t> to_labels(const vector<uint64_t> &classes, const vector<int64_t> &labels)
+{
+     vector<int64_t> v(classes.size());
+     for (uint64_t i = 0; i < classes.size(); i++)
+          v[i] = labels[classes[i] - 1];
+     return v;
+}
+
+/**
+ * @brief Average of a vector's elements.
+ * 
+ * @tparam T Template.
+ * @param v A vector.
+ * @return T Average of elements.
+ */
+template <typename T>
+T vec_average(const vector<T> &v)
+{
+     T sum = 0;
+     for (const T &i : v)
+          sum = sum + i;
+     return sum / (double)v.size();
+}
+
+int main(int argc, char *argv[])
+{
+     try
+     {
+          // Reading the command line options.
+          string model_filename;   // File for saving the model of the cross-validation with the best accuracy (Not saved if empty).
+          string profile_filename; // File for saving the time of each phase in JSON when compiled with -DNN_PROFILE (Not saved if empty).
+          bool use_perf = false;   // Counting hardware events of training and inference.
+          string trace_filename;   // File for saving the timeline of the run in the Chrome trace event format (Not recorded if empty).
+          uint64_t number_workers = 1; // Number of processes of data-parallel training.
+          uint64_t hogwild_threads = 0; // Number of threads of asynchronous training (Synchronous training if zero).
+          uint64_t batch_size = 1;      // Number of instances of a minibatch of asynchronous training.
+          scaling_type scaling = scaling_type::none; // Transform of the features before training.
+          string checkpoint_directory;  // Directory for saving checkpoints of the training (Not saved if empty).
+          uint64_t checkpoint_every = 10; // Number of training iterations between checkpoints.
+          bool resume = false;            // Continuing from the latest checkpoint of checkpoint_directory.
+          optional<uint64_t> seed;        // Seed of the initial weights and the splits of all the folds (Random if not given).
+          uint64_t number_threads = 0;    // Number of threads which compute the deltas of each iteration (The original single-threaded loop if zero).
+          reduction_mode reduction = reduction_mode::deterministic; // The way the deltas of the threads are added.
+          optional<activation_type> output_activation; // Activation function of the output layer, which replaces the one of activations.csv.
+          uint64_t number_samples = 0;                 // Number of sampled classes of the sampled softmax (The full output layer is trained if zero).
+          string libsvm_filename;                      // Sparse dataset in the libsvm format, which replaces x.csv and y.csv (Not used if empty).
+          uint64_t hash_bits = 0;                      // The tokens of x.csv are hashed into 2^hash_bits features (x.csv should only contain numbers if zero).
+          bool signed_hash = false;                    // The features of the tokens are +1 or -1 instead of 1.
+          bool use_gemm = false;                       // Computing the deltas of each iteration with blocked matrix products over blocks of instances.
+          bool use_numa = false;                       // Pinning the threads of multithreaded training and placing their data on their NUMA nodes.
+          bool huge_pages = false;                     // Using transparent huge pages for the weights and the rows of the threads.
+          uint64_t pool_threads = 0;                   // Number of threads of the thread pool (One per CPU if zero).
+          uint64_t prefetch_slots = 0;                 // Number of buffers of the batch loader of --gemm (The blocks are copied by the trainer if zero).
+          for (int i = 1; i < argc; i++)
+          {
+               string option = argv[i];
+               if (option == "--save-model" && i + 1 < argc)
+                    model_filename = argv[++i];
+               else if (option == "--profile-json" && i + 1 < argc)
+                    profile_filename = argv[++i];
+               else if (option == "--perf")
+                    use_perf = true;
+               else if (option == "--trace" && i + 1 < argc)
+                    trace_filename = argv[++i];
+               else if (option == "--workers" && i + 1 < argc)
+                    number_workers = max<uint64_t>(stoull(argv[++i]), 1);
+               else if (option == "--hogwild" && i + 1 < argc)
+                    hogwild_threads = stoull(argv[++i]);
+               else if (option == "--batch" && i + 1 < argc)
+                    batch_size = max<uint64_t>(stoull(argv[++i]), 1);
+               else if (option == "--scale" && i + 1 < argc && (string(argv[i + 1]) == "none" || string(argv[i + 1]) == "standard" || string(argv[i + 1]) == "minmax"))
+                    scaling = to_scaling_type(argv[++i]);
+               else if (option == "--checkpoint" && i + 1 < argc)
+                    checkpoint_directory = argv[++i];
+               else if (option == "--checkpoint-every" && i + 1 < argc)
+                    checkpoint_every = max<uint64_t>(stoull(argv[++i]), 1);
+               else if (option == "--resume")
+                    resume = true;
+               else if (option == "--seed" && i + 1 < argc)
+                    seed = stoull(argv[++i]);
+               else if (option == "--threads" && i + 1 < argc)
+                    number_threads = max<uint64_t>(stoull(argv[++i]), 1);
+               else if (option == "--reduction" && i + 1 < argc && (string(argv[i + 1]) == "fast" || string(argv[i + 1]) == "deterministic"))
+                    reduction = to_reduction_mode(argv[++i]);
+               else if (option == "--output-layer" && i + 1 < argc && (string(argv[i + 1]) == "sigmoid" || string(argv[i + 1]) == "softmax"))
+                    output_activation = to_activation_type(argv[++i]);
+               else if (option == "--sampled-softmax" && i + 1 < argc)
+                    number_samples = max<uint64_t>(stoull(argv[++i]), 1);
+               else if (option == "--libsvm" && i + 1 < argc)
+                    libsvm_filename = argv[++i];
+               else if (option == "--hash-bits" && i + 1 < argc)
+                    hash_bits = stoull(argv[++i]);
+               else if (option == "--signed-hash")
+                    signed_hash = true;
+               else if (option == "--gemm")
+                    use_gemm = true;
+               else if (option == "--numa")
+                    use_numa = true;
+               else if (option == "--huge-pages")
+                    huge_pages = true;
+               else if (option == "--pool" && i + 1 < argc)
+                    pool_threads = max<uint64_t>(stoull(argv[++i]), 1);
+               else if (option == "--prefetch" && i + 1 < argc)
+                    prefetch_slots = max<uint64_t>(stoull(argv[++i]), 2);
+               else
+               {
+                    cout << "Usage: " << argv[0] << " [--save-model file] [--profile-json file] [--perf] [--trace file] [--workers n] [--hogwild threads] [--batch n] [--scale none|standard|minmax] [--checkpoint directory] [--checkpoint-every n] [--resume] [--seed n] [--threads n] [--reduction fast|deterministic] [--output-layer sigmoid|softmax] [--sampled-softmax n] [--libsvm file] [--hash-bits n] [--signed-hash] [--gemm] [--numa] [--huge-pages] [--pool n] [--prefetch n]\n";
+                    return -1;
+               }
+          }
+          if (hogwild_threads > 0 && number_workers > 1)
+          {
+               cout << "Asynchronous training could not be combined with multiple workers!";
+               return -1;
+          }
+          if (resume && checkpoint_directory.empty())
+          {
+               cout << "--resume needs the directory of the checkpoints (--checkpoint directory)!";
+               return -1;
+          }
+          if (number_samples > 0 && (hogwild_threads > 0 || number_threads > 0))
+          {
+               cout << "The sampled softmax could not be combined with asynchronous or multithreaded training!";
+               return -1;
+          }
+          if (use_gemm && (number_threads > 0 || number_samples > 0))
+          {
+               cout << "--gemm could not be combined with multithreaded training or the sampled softmax!";
+               return -1;
+          }
+          if (prefetch_slots > 0 && !use_gemm)
+          {
+               cout << "--prefetch needs the matrix products (--gemm)!";
+               return -1;
+          }
+          if (use_numa && number_threads == 0)
+          {
+               cout << "--numa needs multithreaded training (--threads n)!";
+               return -1;
+          }
+          if (hogwild_threads > 0 && !checkpoint_directory.empty())
+          {
+               cout << "Asynchronous training could not be combined with checkpoints!";
+               return -1;
+          }
+          if (hash_bits > 32 || (hash_bits > 0 && !libsvm_filename.empty()) || (signed_hash && hash_bits == 0))
+          {
+               cout << "--hash-bits should be between 1 and 32 and could not be combined with --libsvm, and --signed-hash needs --hash-bits!";
+               return -1;
+          }
+          if ((!libsvm_filename.empty() || hash_bits > 0) && (number_workers > 1 || hogwild_threads > 0 || number_threads > 0 || number_samples > 0 || use_gemm || scaling != scaling_type::none))
+          {
+               cout << "A sparse dataset could not be combined with multiple workers, asynchronous or multithreaded training, the sampled softmax, --gemm or feature scaling!";
+               return -1;
+          }
+
+          if (!trace_filename.empty())
+               tracer::instance().enable();
+
+          // The threads of the pool are started before the files are read, since the parsing uses them.
+          if (pool_threads > 0)
+               thread_pool::instance().resize(pool_threads);
+
+          string filename;
+          optional<read_x> x;                 // Dense features of x.csv.
+          optional<read_y> y;                 // Classes of y.csv.
+          optional<read_libsvm> libsvm_x;     // Sparse features and classes of the libsvm file.
+          optional<read_hashed_x> hashed_x;   // Sparse features of x.csv with hashed tokens.
+          const sparse_matrix *sparse_x = nullptr; // The sparse features (The features are dense if null).
+          feature_transform transform;
+          vector<int64_t> labels;
+          if (libsvm_filename.empty())
+          {
+               // Reading file x.csv which contains features dataset.
+               filename = "x.csv";
+               if (hash_bits > 0)
+               {
+                    // The tokens are hashed while parsing, so the features go directly to the sparse first layer.
+                    hashed_x.emplace(filename, hash_bits, signed_hash);
+                    sparse_x = &*hashed_x;
+                    cout << "Hashed " << hashed_x->get_tokens() << " tokens of " << hashed_x->get_columns() << " columns into " << (1ULL << hash_bits) << (signed_hash ? " signed" : "") << " features\n";
+               }
+               else
+               {
+                    x.emplace(filename);
+
+                    // Transforming the features with the statistics computed while reading them. The transform is saved with the model.
+                    transform = x->standardize(scaling);
+               }
+
+               // Reading file y.csv which contains output (classes) dataset.
+               filename = "y.csv";
+               y.emplace(filename, true);
+
+               // To check if both x.csv and y.csv have the same number of instances
+               if ((x ? x->get_rows() : hashed_x->get_rows()) != y->get_rows())
+               {
+                    cout << "Error in" << filename << ": Number of rows is not the same as features dataset file!";
+                    return -1;
+               }
+               // The labels of the classes, which could be any integer numbers, are replaced by the class numbers 1, 2, ..., number of classes. The labels are saved with the model unless they are already the class numbers.
+               labels = y->encode_classes();
+          }
+          else
+          {
+               // Reading the sparse dataset.
+               libsvm_x.emplace(libsvm_filename);
+               sparse_x = &*libsvm_x;
+               labels = libsvm_x->encode_classes();
+          }
+          // The sparse features are kept in the CSR format. The train and test sets are the numbers of its rows, so the rows are never copied or expanded.
+          if (sparse_x)
+               cout << "Sparse dataset: " << sparse_x->get_rows() << " rows, " << sparse_x->get_cols() << " features, " << sparse_x->get_nonzeros() << " non-zero values (" << 100.0 * sparse_x->get_nonzeros() / max<double>((double)sparse_x->get_rows() * sparse_x->get_cols(), 1) << "%)\n";
+          const vector<uint64_t> &classes = y ? y->get_values() : libsvm_x->get_classes(); // The class number of each instance.
+
+          uint64_t number_instances = classes.size();                                 // Number of instances in the dataset.
+          uint64_t number_features = sparse_x ? sparse_x->get_cols() : x->get_cols(); // Number of features of the dataset.
+          uint64_t number_classes = labels.size(); // Number of different classes in the dataset.
+          vector<int64_t> model_labels;
+          for (uint64_t i = 0; i < number_classes; i++)
+          {
+               if (labels[i] != (int64_t)i + 1)
+                    model_labels = labels;
+          }
+
+          // Reading layers.csv which contains number of neurons in each layer (except the input and output layer)
+          filename = "layers.csv";
+          read_y number_neurons(filename);
+          if (is_in_vec(number_neurons.get_values(), 0))
+          {
+               cout << "Error in " << filename << ": The number of neurons of a layer should be positive!\n";
+               return -1;
+          }
+
+          // Reading parameters from parameters.csv which contains the paramters of the model.
+          filename = "parameters.csv";
+          configuration parameters(filename);
+
+          // Adding the number of features (number of neurons for the first layer), the number of classes (the number of neurons for the last layer), and the number of neurons of the hidden layers to the vector number_neurons_layer which shows the number of neurons per layer of the network.
+          vector<uint64_t> number_neurons_layer = number_neurons.get_values();
+          number_neurons_layer.insert(number_neurons_layer.begin(), number_features);
+          number_neurons_layer.insert(number_neurons_layer.end(), number_classes);
+
+          // Number of layers in the defined architecture.
+          uint64_t number_layers = number_neurons_layer.size();
+
+          // Reading activations.csv (if it exists) which contains the activation function of each layer except the input layer. Otherwise, sigmoid is used for all the layers.
+          vector<activation_type> activation_functions(number_layers - 1, activation_type::sigmoid);
+          filename = "activations.csv";
+          if (ifstream(filename).good())
+          {
+               activation_functions = read_activations(filename).get_values();
+               if (activation_functions.size() != number_layers - 1)
+               {
+                    cout << "Error in " << filename << ": Number of rows is not the same as the number of hidden and output layers!";
+                    return -1;
+               }
+          }
+          // With a softmax output layer, the activations of the output neurons are the probabilities of the classes, and the errors of the output layer are the gradient of the cross-entropy.
+          if (output_activation)
+               activation_functions.back() = *output_activation;
+          if (number_samples > 0)
+               activation_functions.back() = activation_type::softmax;
+
+          // A vector for saving the accuracy of each trained model using NN.
+          vector<double> cv_accuracy(parameters.get_num_cv());
+
+          // The trained model with the best accuracy.
+          vector<model> best_model;
+
+          // Hardware counters for the training iterations and the inference of the test set.
+          optional<perf_counters> training_counters, inference_counters;
+          if (use_perf)
+          {
+               training_counters.emplace();
+               inference_counters.emplace();
+               if (!training_counters->available())
+               {
+                    cout << "\nHardware counters are not available (perf_event_open is not allowed or not supported).\n";
+                    use_perf = false;
+               }
+          }
+
+          // Continuing from the latest checkpoint. The finished folds are skipped, and an unfinished fold continues with the saved weights. The seed of the run is restored, so the remaining folds are split as in the interrupted run.
+          checkpoint_state resumed;
+          uint64_t start_fold = 0;
+          if (resume)
+          {
+               // Number of edges of the network with the bias units, which the checkpoint should have.
+               uint64_t number_edges = 0;
+               for (uint64_t i = 1; i < number_layers; i++)
+                    number_edges += (number_neurons_layer[i - 1] + 1) * number_neurons_layer[i];
+               if (read_checkpoint(checkpoint_directory, parameters.get_num_cv(), number_edges, resumed))
+               {
+                    start_fold = resumed.fold;
+                    copy(resumed.accuracies.begin(), resumed.accuracies.end(), cv_accuracy.begin());
+                    if (resumed.best_accuracy >= 0 && !model_filename.empty() && ifstream(model_filename).good())
+                         best_model.assign(1, model(model_filename));
+                    seed = resumed.seed;
+                    cout << "Resuming from checkpoint " << resumed.sequence << ": test set " << resumed.fold + 1 << ", iteration " << resumed.iteration << '\n';
+               }
+               else
+               {
+                    cout << "No valid checkpoint in " << checkpoint_directory << ", starting from the beginning.\n";
+                    resumed = checkpoint_state();
+               }
+          }
+
+          // All the random numbers of the run are derived from one seed, which is printed so the run could be repeated.
+          if (!seed)
+               seed = random_device()();
+          cout << "Seed: " << *seed << '\n';
+
+          // The checkpoints are written by a background thread.
+          unique_ptr<checkpoint_writer> writer;
+          double checkpoint_time = 0;    // Time of the training loop spent submitting checkpoints in seconds.
+          uint64_t trained_iterations = 0; // Training iterations of this run.
+
+          // Cross validation with num_cv iterations.
+          for (uint64_t count = start_fold; count < parameters.get_num_cv(); count++)
+          {
+               scoped_trace fold_trace("fold", "fold", count + 1);
+               bool resume_fold = count == resumed.fold && resumed.iteration > 0;
+
+               // Creating train and test sets by splitting data randomly based on the train percentage.
+               vector<double> random_numbers(number_instances);                                                                      // Creating random number for splitting data.
+               vector<uint64_t> order(number_instances);                                                                             // The instances in the order of their random numbers.
+               vector<vector<double>> train_x(x ? number_instances * parameters.get_train_percantage() / 100 : 0);                   // Train set of x (features).
+               vector<vector<double>> test_x(x ? number_instances - number_instances * parameters.get_train_percantage() / 100 : 0); // Test set of x (features).
+               vector<uint64_t> train_rows, test_rows;                                                                               // Rows of the sparse dataset in the train and test sets.
+               vector<uint64_t> train_classes(number_instances * parameters.get_train_percantage() / 100);                           // Classes of the train set.
+               vector<uint64_t> test_classes(number_instances - number_instances * parameters.get_train_percantage() / 100);         // Classes of the test set.
+
+               {
+                    PROFILE_SCOPE(split);
+                    scoped_trace trace_scope("split");
+                    // Creating a random number for each instance from the seed and the fold.
+                    counter_rng(*seed, random_stream::split, count).fill_uniform(random_numbers);
+
+                    // Sorting the instances by their random numbers and choosing the first train_percentage as train set.
+                    for (uint64_t i = 0; i < number_instances; i++)
+                         order[i] = i;
+                    stable_sort(order.begin(), order.end(), [&](const uint64_t &a, const uint64_t &b)
+                                { return random_numbers[a] < random_numbers[b]; });
+
+                    // Train set.
+                    uint64_t j = 0;
+                    for (uint64_t i = 0; i < number_instances * parameters.get_train_percantage() / 100; i++)
+                    {
+                         if (x)
+                              train_x[j] = x->get_values()[order[i]];
+                         else
+                              train_rows.push_back(order[i]);
+                         train_classes[j] = classes[order[i]];
+                         j++;
+                    }
+
+                    // Test set.
+                    j = 0;
+                    for (uint64_t i = number_instances * parameters.get_train_percantage() / 100; i < number_instances; i++)
+                    {
+                         if (x)
+                              test_x[j] = x->get_values()[order[i]];
+                         else
+                              test_rows.push_back(order[i]);
+                         test_classes[j] = classes[order[i]];
+                         j++;
+                    }
+               }
+
+               vector<layer> layers;   // Vector which includes the layers of NN.
+               vector<neuron> neurons; // Vector which includes the neurons of NN.
+               vector<edge> edges;     //vector of all edges of NN.
+
+               // Generating the network.
+               network N = generate_network(number_neurons_layer, activation_functions, layers, neurons, edges, counter_rng(*seed, random_stream::weights, count));
+               if (huge_pages)
+                    advise_huge_pages(edges.data(), edges.size() * sizeof(edge));
+
+               // Restoring the weights of an unfinished fold before the workers are forked, so all of them continue from the checkpoint.
+               uint64_t start_iteration = 0;
+               if (resume_fold)
+               {
+                    N.set_weights(edges, resumed.weights, resumed.gradients);
+                    start_iteration = resumed.iteration;
+               }
+               if (!checkpoint_directory.empty() && !writer)
+                    writer = make_unique<checkpoint_writer>(checkpoint_directory, edges.size(), parameters.get_num_cv(), resumed.sequence + 1);
+
+               // With more than one worker, the worker processes are forked after the network is generated, so they start with the same weights and train set. Each worker trains on its own shard of the train set and the deltas are summed through shared memory, so all the workers make the same updates. Rank 0 is this process, which continues with the evaluation.
+               uint64_t number_train = number_instances * parameters.get_train_percantage() / 100;
+               uint64_t rank = 0;
+               vector<int> workers; // Process IDs of the other workers.
+               unique_ptr<transport> workers_transport;
+               vector<double> delta_buffer;
+               if (number_workers > 1)
+               {
+#ifdef __linux__
+                    cout.flush();
+                    for (uint64_t r = 1; r < number_workers; r++)
+                    {
+                         int pid = fork();
+                         if (pid == 0)
+                         {
+                              rank = r;
+                              workers.clear();
+                              // The child only has this thread, so the pool starts its own workers.
+                              thread_pool::instance().restart_after_fork();
+                              break;
+                         }
+                         if (pid < 0)
+                         {
+                              cout << "Error creating the worker processes!";
+                              return -1;
+                         }
+                         workers.push_back(pid);
+                    }
+                    try
+                    {
+                         workers_transport = make_unique<shared_memory_transport>("/nn_allreduce_" + to_string(rank == 0 ? getpid() : getppid()), rank, number_workers, edges.size());
+                    }
+                    catch (const exception &e)
+                    {
+                         cout << e.what() << '\n';
+                         if (rank > 0)
+                              _exit(1);
+                         return -1;
+                    }
+                    delta_buffer.resize(edges.size());
+#else
+                    cout << "Multiple workers are only supported on Linux!";
+                    return -1;
+#endif
+               }
+               uint64_t shard_begin = rank * number_train / number_workers, shard_end = (rank + 1) * number_train / number_workers;
+
+               // The threads are started after the workers are forked, since a forked process only has the thread which forked it.
+               // With several workers, the threads of worker r are placed after the threads of the workers before it.
+               unique_ptr<numa_topology> topology;
+               if (use_numa)
+                    topology = make_unique<numa_topology>();
+               unique_ptr<gradient_accumulator> accumulator;
+               if (number_threads > 0)
+                    accumulator = make_unique<gradient_accumulator>(layers, neurons, edges, number_threads, reduction, topology.get(), huge_pages, rank * number_threads);
+               unique_ptr<gemm_accumulator> matrix_accumulator;
+               if (use_gemm)
+                    matrix_accumulator = make_unique<gemm_accumulator>(layers, neurons, 256, huge_pages);
+
+               // The blocks of the shard of this worker are gathered in the background while the previous block is trained on. The instances are shuffled in each iteration by the seed, the fold and the iteration.
+               unique_ptr<batch_loader> loader;
+               if (prefetch_slots > 0)
+               {
+                    vector<uint64_t> shard_order(shard_end - shard_begin);
+                    iota(shard_order.begin(), shard_order.end(), shard_begin);
+                    loader = make_unique<batch_loader>(train_x, train_classes, shard_order, matrix_accumulator->get_block_rows(), prefetch_slots, counter_rng(*seed, random_stream::batches, count), start_iteration);
+               }
+
+               // The sampled classes of each instance are drawn from the seed, the fold, the iteration and the instance.
+               counter_rng sample_rng(*seed, random_stream::samples, count);
+               vector<uint64_t> sampled;
+               sampled.reserve(number_samples + 1);
+
+               // The number of steps of the epoch applied to the weights of each feature of a sparse dataset.
+               vector<uint64_t> applied_steps(sparse_x ? number_features + 1 : 0);
+
+               // With asynchronous training, the synchronous training still runs from the same initial weights for comparing the cost after every tenth of the iterations.
+               vector<edge> hogwild_edges;
+               uint64_t report_interval = max<uint64_t>(parameters.get_num_iteration() / 10, 1);
+               vector<double> synchronous_cost;
+               if (hogwild_threads > 0)
+                    hogwild_edges = edges;
+               chrono::steady_clock::time_point synchronous_start = chrono::steady_clock::now();
+               double synchronous_time = 0;
+
+               // Training the network using train set for num_iteration iterations.
+               if (use_perf)
+               {
+                    training_counters->reset();
+                    training_counters->start();
+               }
+               uint64_t steady_allocations = 0; // Allocations of the training iterations after the first one (Counted with -DNN_TRACK_ALLOC).
+               chrono::steady_clock::time_point training_start = chrono::steady_clock::now();
+               for (uint64_t k = start_iteration; k < parameters.get_num_iteration(); k++)
+               {
+                    scoped_trace iteration_trace("iteration", "iteration", k + 1);
+                    uint64_t allocations_start = track_allocations ? profiler::instance().get_allocations() : 0;
+
+                    // With a sparse dataset, an iteration is an epoch of minibatch SGD which only updates the weights of the non-zero features of each minibatch.
+                    if (sparse_x)
+                         N.sparse_sgd_epoch(layers, neurons, edges, sparse_x->get_row_offsets(), sparse_x->get_feature_indices(), sparse_x->get_values(), train_rows, train_classes, batch_size, parameters.get_learning_rate(), parameters.get_lambda(), applied_steps);
+                    // Computing the deltas of the shard of this worker with several threads.
+                    else if (accumulator)
+                         accumulator->accumulate(N, edges, train_x, train_classes, shard_begin, shard_end);
+                    // Computing the deltas of the shard of this worker with matrix products.
+                    else if (matrix_accumulator && loader)
+                         matrix_accumulator->accumulate(N, edges, *loader);
+                    else if (matrix_accumulator)
+                         matrix_accumulator->accumulate(N, edges, train_x, train_classes, shard_begin, shard_end);
+                    else
+                    {
+                         // Setting delta equal to zero at the beginning of each iteration
+                         for (edge &i : edges)
+                              i.set_delta_zero();
+
+                         // Train using instance number t of the shard of this worker (The whole train set with one worker).
+                         for (uint64_t t = shard_begin; t < shard_end; t++)
+                         {
+                              if (number_samples > 0)
+                              {
+                                   N.sampled_propagation(layers, neurons, edges, train_x[t], train_classes[t], sample_rng, (k * number_train + t) * number_samples, number_samples, sampled);
+                                   continue;
+                              }
+
+                              // Activate layers of the network.
+                              N.forward_propagation(layers, neurons, edges, train_x[t]);
+
+                              // Find the error for layers of NN and update delta for each edge.
+                              N.back_propagation(layers, neurons, edges, train_classes[t]);
+                         }
+                    }
+                    PROFILE_COUNT(instances_trained, shard_end - shard_begin);
+
+                    // Sum the deltas of all the workers.
+                    if (workers_transport)
+                         N.delta_allreduce(edges, delta_buffer, *workers_transport);
+
+                    if (!sparse_x)
+                    {
+                         // Update gradient of each edge.
+                         N.gradient_update(edges, number_instances * parameters.get_train_percantage() / 100, parameters.get_lambda());
+
+                         // Run gradient descent algorithm to update the weights of the edges.
+                         N.gradient_descent(edges, parameters.get_learning_rate());
+                    }
+
+                    // Copying the state into a snapshot, which is written by the background thread.
+                    if (writer && rank == 0 && (k + 1) % checkpoint_every == 0)
+                    {
+                         PROFILE_SCOPE(checkpoint);
+                         chrono::steady_clock::time_point checkpoint_start = chrono::steady_clock::now();
+                         writer->submit(count, k + 1, *seed, cv_accuracy, best_model.empty() ? -1 : *max_element(cv_accuracy.begin(), cv_accuracy.begin() + count), edges);
+                         checkpoint_time += chrono::duration<double>(chrono::steady_clock::now() - checkpoint_start).count();
+                    }
+                    trained_iterations++;
+
+                    // The first iteration is the warm-up.
+                    if (track_allocations && k > start_iteration)
+                         steady_allocations += profiler::instance().get_allocations() - allocations_start;
+
+                    PROFILE_COUNT(iterations, 1);
+                    PROFILE_END_ITERATION();
+
+                    if (hogwild_threads > 0 && ((k + 1) % report_interval == 0 || k + 1 == parameters.get_num_iteration()))
+                    {
+                         synchronous_time += chrono::duration<double>(chrono::steady_clock::now() - synchronous_start).count();
+                         synchronous_cost.push_back(N.cost(layers, neurons, edges, train_x, train_classes));
+                         synchronous_start = chrono::steady_clock::now();
+                    }
+               }
+               if (use_perf)
+                    training_counters->stop();
+
+               // The placement of the threads of the first fold and the training time, which could be compared with a run without --numa.
+               if (topology && rank == 0 && count == start_fold)
+               {
+                    cout << "\nPlacement of the threads\n";
+                    accumulator->print_placement(cout);
+                    cout << "Training time: " << chrono::duration<double>(chrono::steady_clock::now() - training_start).count() << " s\n";
+               }
+
+               // The batches which the trainer waited for, which should only be the first one of the fold.
+               if (loader && rank == 0 && count == start_fold)
+               {
+                    cout << '\n';
+                    loader->print_statistics(cout);
+               }
+               loader.reset();
+
+               // The other workers finish after the training, and rank 0 has the same weights.
+               if (rank > 0)
+               {
+                    accumulator.reset();
+                    workers_transport.reset();
+                    cout.flush();
+                    _exit(0);
+               }
+#ifdef __linux__
+               for (const int &pid : workers)
+               {
+                    int status = 0;
+                    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                    {
+                         cout << "Error in a worker process!";
+                         return -1;
+                    }
+               }
+#endif
+               workers_transport.reset();
+
+               // Asynchronous training, whose model replaces the synchronous one for the evaluation.
+               if (hogwild_threads > 0)
+               {
+                    cout << "\nConvergence of synchronous gradient descent and asynchronous SGD (" << hogwild_threads << " threads, minibatch " << batch_size << ")\n";
+                    cout << "epochs\tsynchronous cost\tasynchronous cost\n";
+                    double hogwild_time = 0;
+                    for (uint64_t k = 0, report = 0; k < parameters.get_num_iteration(); report++)
+                    {
+                         uint64_t epochs = min(report_interval, parameters.get_num_iteration() - k);
+                         chrono::steady_clock::time_point hogwild_start = chrono::steady_clock::now();
+                         N.hogwild_train(layers, neurons, hogwild_edges, train_x, train_classes, hogwild_threads, epochs, batch_size, parameters.get_learning_rate(), parameters.get_lambda());
+                         hogwild_time += chrono::duration<double>(chrono::steady_clock::now() - hogwild_start).count();
+                         k += epochs;
+                         cout << k << '\t' << synchronous_cost[report] << '\t' << N.cost(layers, neurons, hogwild_edges, train_x, train_classes) << '\n';
+                    }
+                    cout << "Training time: " << synchronous_time << " s synchronous, " << hogwild_time << " s asynchronous\n";
+                    edges = hogwild_edges;
+               }
+
+               // Test the trained model on the test set.
+               vector<uint64_t> predicted_classes(number_instances - number_instances * parameters.get_train_percantage() / 100); //Vector containing the predicted classes.
+
+               // The dense test set is copied into a matrix and scored in batches by the thread pool with model::forward_batch(), whose products use the pool as well. The activations and the workspace of each batch are allocated before the inference.
+               const uint64_t evaluation_rows = 64; // Number of instances of a batch of the evaluation.
+               optional<model> evaluation_model;
+               vector<double> test_matrix, test_outputs;
+               vector<vector<double>> evaluation_workspaces;
+               if (!sparse_x)
+               {
+                    evaluation_model.emplace(number_neurons_layer, activation_functions, edges);
+                    test_matrix.resize(predicted_classes.size() * number_features);
+                    for (uint64_t t = 0; t < predicted_classes.size(); t++)
+                         copy(test_x[t].begin() + 1, test_x[t].end(), &test_matrix[t * number_features]);
+                    test_outputs.resize(predicted_classes.size() * number_classes);
+                    evaluation_workspaces.assign((predicted_classes.size() + evaluation_rows - 1) / evaluation_rows, vector<double>(evaluation_model->workspace_size(evaluation_rows)));
+               }
+               uint64_t inference_allocations = track_allocations ? profiler::instance().get_allocations() : 0;
+
+               {
+                    PROFILE_SCOPE(evaluation); // Includes the forward propagation of the test set.
+                    scoped_trace trace_scope("evaluation");
+                    if (use_perf)
+                    {
+                         inference_counters->reset();
+                         inference_counters->start();
+                    }
+                    if (sparse_x)
+                    {
+                         for (uint64_t t = 0; t < predicted_classes.size(); t++)
+                         {
+                              // Activate layers of the network
+                              const uint64_t &begin = sparse_x->get_row_offsets()[test_rows[t]], &end = sparse_x->get_row_offsets()[test_rows[t] + 1];
+                              N.sparse_forward_propagation(layers, neurons, edges, &sparse_x->get_feature_indices()[begin], &sparse_x->get_values()[begin], end - begin);
+
+                              // Find category based on the neuron with maximum activation in the last layer.
+                              predicted_classes[t] = N.predict_class(neurons, number_layers, number_classes);
+                         }
+                    }
+                    else
+                    {
+                         thread_pool::instance().parallel_for(0, evaluation_workspaces.size(), 1, [&](const uint64_t &begin, const uint64_t &end)
+                                                              {
+                                                                   for (uint64_t b = begin; b < end; b++)
+                                                                   {
+                                                                        uint64_t first = b * evaluation_rows, rows = min(evaluation_rows, predicted_classes.size() - first);
+                                                                        evaluation_model->forward_batch(&test_matrix[first * number_features], rows, &test_outputs[first * number_classes], evaluation_workspaces[b]);
+                                                                        // The category is the first neuron with the maximum activation, as in network::predict_class().
+                                                                        for (uint64_t r = first; r < first + rows; r++)
+                                                                             predicted_classes[r] = evaluation_model->predict(&test_outputs[r * number_classes]);
+                                                                   }
+                                                              });
+                    }
+                    if (use_perf)
+                         inference_counters->stop();
+                    PROFILE_COUNT(instances_evaluated, predicted_classes.size());
+               }
+               inference_allocations = track_allocations ? profiler::instance().get_allocations() - inference_allocations : 0;
+
+               // The training and inference loops should not allocate after the warm-up. The timeline allocates for its events, so it is not checked while tracing.
+               if ((steady_allocations > 0 || inference_allocations > 0) && trace_filename.empty())
+               {
+                    cout << "\nError: " << steady_allocations << " allocations in the training iterations after the first one and " << inference_allocations << " allocations in the inference of the test set!\n";
+                    return -1;
+               }
+               // Calculate the accuracy of the predicted classes for the test set.
+               cv_accuracy[count] = accuracy(predicted_classes, test_classes);
+               if (best_model.empty() || cv_accuracy[count] > *max_element(cv_accuracy.begin(), cv_accuracy.begin() + count))
+               {
+                    best_model.assign(1, model(number_neurons_layer, activation_functions, edges, transform, model_labels));
+                    // With checkpoints, the best model is saved when it changes, so a resumed run could still save it.
+                    if (writer && !model_filename.empty())
+                         best_model[0].save(model_filename);
+               }
+               if (writer)
+                    writer->submit(count + 1, 0, *seed, cv_accuracy, *max_element(cv_accuracy.begin(), cv_accuracy.begin() + count + 1), edges);
+               cout << "\nTest set " << count + 1 << "\n\nPrediction accuracy: " << cv_accuracy[count] << "\n";
+               if (use_perf)
+               {
+                    cout << "\nHardware counters for training:\n";
+                    training_counters->print(cout, parameters.get_num_iteration() * (number_instances * parameters.get_train_percantage() / 100), "training instance");
+                    cout << "\nHardware counters for inference:\n";
+                    inference_counters->print(cout, predicted_classes.size(), "test instance");
+               }
+               cout << "\nPreticted classes for the test set:\n";
+               print_elements(to_labels(predicted_classes, labels));
+               cout << "\nActual classes for the test set:\n";
+               print_elements(to_labels(test_classes, labels));
+          }
+          // Average accuracy of all trained models.
+          cout << "\nAverage accuracy: " << vec_average(cv_accuracy);
+
+          // The parsing, initialization, products and evaluation which were run by the thread pool.
+          cout << "\n\n";
+          thread_pool::instance().print_statistics(cout);
+
+          if (writer)
+          {
+               writer->flush();
+               cout << "\nCheckpoints: " << writer->get_written() << " written to " << checkpoint_directory << " (" << writer->get_replaced() << " replaced by a newer one before writing), overhead of the training loop " << (trained_iterations > 0 ? checkpoint_time * 1e6 / trained_iterations : 0) << " us per iteration\n";
+          }
+
+          // Saving the best trained model, which could be loaded by fixed_network.
+          if (!model_filename.empty() && !best_model.empty())
+          {
+               best_model[0].save(model_filename);
+               cout << "\nBest model saved to " << model_filename << '\n';
+          }
+
+          if (!trace_filename.empty())
+          {
+               tracer::instance().write(trace_filename);
+               cout << "\nTimeline saved to " << trace_filename << '\n';
+          }
+
+#ifdef NN_PROFILE
+          // Time spent in each phase.
+          profiler::instance().print_summary(cout);
+          if (!profile_filename.empty())
+          {
+               ofstream output(profile_filename);
+               profiler::instance().write_json(output);
+          }
+#endif
+     }
+     catch (const exception &e)
+     {
+          return -1;
+     }
 }
\ No newline at end of file
@@ -0,0 +1,514 @@
+#include <iostream>
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+class model
+{
+
+public:
+    /**
+    * @brief Construct a new model::model object from a trained network.
+    *
+    * @param _number_nodes Vector containing the number of neurons in each layer (Except the bias unit).
+    * @param _activation_functions Activation function of each layer except the input layer.
+    * @param edges Vector containing all the edges of the trained network.
+    * @param _transform Transform of the features which was applied before training.
+    * @param _labels The label of each class number, if the labels of the dataset were replaced by class numbers (Empty otherwise).
+    */
+    model(const vector<uint64_t> &, const vector<activation_type> &, const vector<edge> &, const feature_transform & = feature_transform(), const vector<int64_t> & = vector<int64_t>());
+
+    /**
+    * @brief Construct a new model::model object by reading a model saved with save().
+    *
+    * @param filename The file name that contains the model.
+    */
+    model(const string &);
+
+    /**
+    * @brief Member function to save the model to a file. Each line starts with a key: "layers" for the number of neurons in each layer, "activations" for the activation functions, "theta" followed by the layer number for each row of the weight matrices, "offset" and "scale" for the transform of the features (If any), and "labels" for the label of each class (If any).
+    *
+    * @param filename The file name for saving the model.
+    */
+    void save(const string &) const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of neurons in each layer (Except the bias unit).
+    *
+    * @return vector<uint64_t> Number of neurons in each layer.
+    */
+    vector<uint64_t> get_number_nodes() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the activation function of each layer except the input layer.
+    *
+    * @return vector<activation_type> Activation functions.
+    */
+    vector<activation_type> get_activation_functions() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the weight matrix theta^l of the edges connecting layer l to l+1. The matrix has s_{l+1} rows and s_l + 1 columns stored row by row, and column 0 belongs to the bias unit. If the features were transformed before training, the transform is folded into theta^1, so the weights apply directly to the raw features.
+    *
+    * @param l Layer number where the edges start.
+    * @return const vector<double>& Weight matrix of the layer.
+    */
+    const vector<double> &get_theta(const uint64_t &) const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the transform of the features which was applied before training.
+    *
+    * @return const feature_transform& The transform (Empty if the features were not transformed).
+    */
+    const feature_transform &get_transform() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the label of each class number.
+    *
+    * @return const vector<int64_t>& The labels (Empty if the classes are the labels).
+    */
+    const vector<int64_t> &get_labels() const;
+
+    /**
+    * @brief Member function to compute the activations of the output layer for a batch of instances. The weighted sums of a layer are one blocked matrix product (gemm()) of the activations of the batch and the weights, so the weights are read from memory once per block of instances instead of once per instance.
+    *
+    * @param x Feature values of the instances stored row by row (Without the bias unit).
+    * @param rows Number of instances.
+    * @param y Activations of the output layer stored row by row.
+    * @param workspace Vector for the activations of the hidden layers and the packed blocks of the products (Resized if it is too small, so passing the same vector avoids allocating for every batch).
+    */
+    void forward_batch(const double *, const uint64_t &, double *, vector<double> &) const;
+
+    /**
+    * @brief Member function to obtain the size of the workspace of forward_batch() for a number of instances, so the workspaces of several batches could be allocated before they are computed.
+    *
+    * @param rows Number of instances.
+    * @return uint64_t Number of doubles.
+    */
+    uint64_t workspace_size(const uint64_t &) const;
+
+    /**
+    * @brief Member function to find the predicted class of an instance from the activations of the output layer.
+    *
+    * @param y Activations of the output layer of the instance.
+    * @return int64_t The label of the predicted class (The class number starting from 1 if there are no labels).
+    */
+    int64_t predict(const double *) const;
+
+    /**
+     * @brief Error if the data is not a real number.
+     *
+     */
+    class not_number : public invalid_argument
+    {
+    public:
+        not_number() : invalid_argument("Expected a number!"){};
+    };
+
+    /**
+     * @brief Error if the key at the beginning of a line is unknown.
+     *
+     */
+    class unknown_key : public invalid_argument
+    {
+    public:
+        unknown_key() : invalid_argument("Expected layers, activations, theta, offset, scale or labels at the beginning of the line!"){};
+    };
+
+    /**
+     * @brief Error if the weights do not match the number of neurons of the layers.
+     *
+     */
+    class size_mismatch : public length_error
+    {
+    public:
+        size_mismatch() : length_error("The number of weights does not match the number of neurons of the layers!"){};
+    };
+
+    /**
+     * @brief Error if there is a problem with the file.
+     *
+     */
+    class invalid_file : public invalid_argument
+    {
+    public:
+        invalid_file() : invalid_argument(""){};
+    };
+
+private:
+    /**
+     * @brief Number of neurons in each layer (Except the bias unit).
+     *
+     */
+    vector<uint64_t> number_nodes;
+
+    /**
+     * @brief Activation function of each layer except the input layer.
+     *
+     */
+    vector<activation_type> activation_functions;
+
+    /**
+     * @brief Weight matrices. theta[l - 1] contains the weights of the edges connecting layer l to l+1.
+     *
+     */
+    vector<vector<double>> theta;
+
+    /**
+     * @brief Transform of the features which was applied before training.
+     *
+     */
+    feature_transform transform;
+
+    /**
+     * @brief The label of each class number (Empty if the classes are the labels).
+     *
+     */
+    vector<int64_t> labels;
+
+    /**
+     * @brief theta^1 with the transform of the features folded in (Empty if there is no transform).
+     *
+     */
+    vector<double> input_theta;
+
+    /**
+     * @brief Member function to fold the transform of the features into theta^1: since z = w_0 + sum_k w_k (x_k - offset_k) scale_k, the bias becomes w_0 - sum_k w_k offset_k scale_k and the weights become w_k scale_k.
+     *
+     */
+    void fold_transform();
+
+    /**
+     * @brief Member function to compute the activations of a layer for a batch of instances.
+     *
+     * @tparam Activation Activation policy of the layer.
+     * @param l Layer number where the edges start.
+     * @param in Activations of layer l stored row by row.
+     * @param rows Number of instances.
+     * @param out Activations of layer l + 1 stored row by row.
+     * @param packing Memory for the packed blocks of gemm().
+     */
+    template <typename Activation>
+    void forward_layer(const uint64_t &, const double *, const uint64_t &, double *, double *) const;
+};
+
+/**
+ * @brief Overloaded binary operator << to easily print out the architecture of a model to a stream.
+ *
+ * @param out Output stream.
+ * @param m The model.
+ * @return ostream& The number of neurons and activation function of each layer.
+ */
+ostream &operator<<(ostream &, const model &);
+
+/**
+ * @brief Converts a string to a real number and checks that the whole string was used.
+ *
+ * @param s The string to be converted.
+ * @return double The real number.
+ */
+double to_double(const string &);
+
+// ==============
+// Implementation
+// ==============
+
+model::model(const vector<uint64_t> &_number_nodes, const vector<activation_type> &_activation_functions, const vector<edge> &edges, const feature_transform &_transform, const vector<int64_t> &_labels)
+    : number_nodes(_number_nodes), activation_functions(_activation_functions), transform(_transform), labels(_labels)
+{
+    for (uint64_t l = 1; l < number_nodes.size(); l++)
+        theta.push_back(vector<double>(number_nodes[l] * (number_nodes[l - 1] + 1), 0));
+
+    for (const edge &i : edges)
+        theta[i.get_start_layer() - 1][(i.get_end_number() - 1) * (number_nodes[i.get_start_layer() - 1] + 1) + i.get_start_number()] = i.get_weight();
+    fold_transform();
+}
+
+model::model(const string &filename)
+{
+    ifstream input(filename);
+    if (!input.is_open())
+    {
+        cout << "Error opening " << filename << " input file!";
+        throw invalid_file();
+    }
+    uint64_t line = 0;
+    string s;
+    vector<double> offset, scale;
+    while (getline(input, s))
+    {
+        line++;
+        if (!s.empty() && s.back() == '\r')
+            s.pop_back();
+        try
+        {
+            istringstream string_stream(s);
+            string key, value;
+            getline(string_stream, key, ',');
+            if (key == "layers")
+            {
+                while (getline(string_stream, value, ','))
+                    number_nodes.push_back(stoull(value));
+                for (uint64_t l = 1; l < number_nodes.size(); l++)
+                    theta.push_back(vector<double>());
+            }
+            else if (key == "activations")
+            {
+                while (getline(string_stream, value, ','))
+                    activation_functions.push_back(to_activation_type(value));
+            }
+            else if (key == "theta")
+            {
+                getline(string_stream, value, ',');
+                uint64_t l = stoull(value);
+                if (l < 1 || l > theta.size())
+                    throw size_mismatch();
+                while (getline(string_stream, value, ','))
+                    theta[l - 1].push_back(to_double(value));
+            }
+            else if (key == "offset" || key == "scale")
+            {
+                vector<double> &parameters = key == "offset" ? offset : scale;
+                while (getline(string_stream, value, ','))
+                    parameters.push_back(to_double(value));
+            }
+            else if (key == "labels")
+            {
+                while (getline(string_stream, value, ','))
+                    labels.push_back(stoll(value));
+            }
+            else
+                throw unknown_key();
+        }
+        catch (const exception &e)
+        {
+            cout << "Error in line " << line << " " << filename << ": " << e.what() << '\n';
+            throw invalid_file();
+        }
+    }
+    if (activation_functions.size() + 1 != number_nodes.size())
+    {
+        cout << "Error in " << filename << ": " << size_mismatch().what() << '\n';
+        throw invalid_file();
+    }
+    for (uint64_t l = 1; l < number_nodes.size(); l++)
+    {
+        if (theta[l - 1].size() != number_nodes[l] * (number_nodes[l - 1] + 1))
+        {
+            cout << "Error in " << filename << ": " << size_mismatch().what() << '\n';
+            throw invalid_file();
+        }
+    }
+    if (offset.size() != scale.size() || (!offset.empty() && offset.size() != number_nodes[0]) || (!labels.empty() && labels.size() != number_nodes.back()))
+    {
+        cout << "Error in " << filename << ": " << size_mismatch().what() << '\n';
+        throw invalid_file();
+    }
+    transform = feature_transform(offset, scale);
+    fold_transform();
+    input.close();
+}
+
+void model::fold_transform()
+{
+    if (transform.empty() || number_nodes.size() < 2)
+        return;
+    uint64_t inputs = number_nodes[0];
+    input_theta = theta[0];
+    for (uint64_t j = 0; j < number_nodes[1]; j++)
+    {
+        double *row = &input_theta[j * (inputs + 1)];
+        for (uint64_t k = 0; k < inputs; k++)
+        {
+            row[k + 1] *= transform.get_scale()[k];
+            row[0] -= row[k + 1] * transform.get_offset()[k];
+        }
+    }
+}
+
+void model::save(const string &filename) const
+{
+    ofstream output(filename);
+    if (!output.is_open())
+    {
+        cout << "Error opening " << filename << " output file!";
+        throw invalid_file();
+    }
+    output << setprecision(17); // Enough digits to read back exactly the same weights.
+
+    output << "layers";
+    for (const uint64_t &i : number_nodes)
+        output << ',' << i;
+    output << '\n';
+
+    output << "activations";
+    for (const activation_type &i : activation_functions)
+        output << ',' << i;
+    output << '\n';
+
+    for (uint64_t l = 1; l < number_nodes.size(); l++)
+    {
+        for (uint64_t j = 0; j < number_nodes[l]; j++)
+        {
+            output << "theta," << l;
+            for (uint64_t k = 0; k <= number_nodes[l - 1]; k++)
+                output << ',' << theta[l - 1][j * (number_nodes[l - 1] + 1) + k];
+            output << '\n';
+        }
+    }
+
+    if (!transform.empty())
+    {
+        output << "offset";
+        for (const double &i : transform.get_offset())
+            output << ',' << i;
+        output << "\nscale";
+        for (const double &i : transform.get_scale())
+            output << ',' << i;
+        output << '\n';
+    }
+
+    if (!labels.empty())
+    {
+        output << "labels";
+        for (const int64_t &i : labels)
+            output << ',' << i;
+        output << '\n';
+    }
+    output.close();
+}
+
+vector<uint64_t> model::get_number_nodes() const
+{
+    return number_nodes;
+}
+
+vector<activation_type> model::get_activation_functions() const
+{
+    return activation_functions;
+}
+
+const vector<double> &model::get_theta(const uint64_t &l) const
+{
+    return l == 1 && !input_theta.empty() ? input_theta : theta[l - 1];
+}
+
+const feature_transform &model::get_transform() const
+{
+    return transform;
+}
+
+const vector<int64_t> &model::get_labels() const
+{
+    return labels;
+}
+
+void model::forward_batch(const double *x, const uint64_t &rows, double *y, vector<double> &workspace) const
+{
+    uint64_t width = *max_element(number_nodes.begin(), number_nodes.end());
+    if (workspace.size() < workspace_size(rows))
+        workspace.resize(workspace_size(rows));
+    double *packing = &workspace[2 * rows * width];
+    const double *in = x;
+    for (uint64_t l = 1; l < number_nodes.size(); l++)
+    {
+        // The hidden layers alternate between the two halves of the workspace, and the output layer is written to y.
+        double *out = l + 1 == number_nodes.size() ? y : &workspace[(l % 2) * rows * width];
+        switch (activation_functions[l - 1])
+        {
+        case activation_type::sigmoid:
+            forward_layer<sigmoid_activation>(l, in, rows, out, packing);
+            break;
+        case activation_type::tanh:
+            forward_layer<tanh_activation>(l, in, rows, out, packing);
+            break;
+        case activation_type::relu:
+            forward_layer<relu_activation>(l, in, rows, out, packing);
+            break;
+        case activation_type::leaky_relu:
+            forward_layer<leaky_relu_activation>(l, in, rows, out, packing);
+            break;
+        case activation_type::softmax:
+            forward_layer<softmax_activation>(l, in, rows, out, packing);
+            break;
+        }
+        in = out;
+    }
+}
+
+template <typename Activation>
+void model::forward_layer(const uint64_t &l, const double *in, const uint64_t &rows, double *out, double *packing) const
+{
+    // z = w_0 + sum_k w_k a_k: the sums start from the biases, and the weights without the biases (column 0 of theta^l) are multiplied as the transpose of theta^l.
+    uint64_t inputs = number_nodes[l - 1], outputs = number_nodes[l];
+    const double *theta = get_theta(l).data();
+    for (uint64_t r = 0; r < rows; r++)
+        for (uint64_t j = 0; j < outputs; j++)
+            out[r * outputs + j] = theta[j * (inputs + 1)];
+    gemm(false, true, rows, outputs, inputs, in, inputs, theta + 1, inputs + 1, 1, out, outputs, packing);
+
+    for (uint64_t r = 0; r < rows; r++)
+    {
+        double *o = out + r * outputs;
+        if constexpr (Activation::normalizes_layer)
+        {
+            double max_input = *max_element(o, o + outputs);
+            double sum = 0;
+            for (uint64_t j = 0; j < outputs; j++)
+            {
+                o[j] = Activation::activate(o[j] - max_input);
+                sum += o[j];
+            }
+            for (uint64_t j = 0; j < outputs; j++)
+                o[j] /= sum;
+        }
+        else
+        {
+            for (uint64_t j = 0; j < outputs; j++)
+                o[j] = Activation::activate(o[j]);
+        }
+    }
+}
+
+uint64_t model::workspace_size(const uint64_t &rows) const
+{
+    uint64_t width = *max_element(number_nodes.begin(), number_nodes.end());
+    uint64_t packing_size = 0;
+    for (uint64_t l = 1; l < number_nodes.size(); l++)
+        packing_size = max(packing_size, gemm_workspace_size(rows, number_nodes[l], number_nodes[l - 1]));
+    return 2 * rows * width + packing_size;
+}
+
+int64_t model::predict(const double *y) const
+{
+    int64_t predicted = max_element(y, y + number_nodes.back()) - y + 1;
+    return labels.empty() ? predicted : labels[predicted - 1];
+}
+
+ostream &operator<<(ostream &out, const model &m)
+{
+    out << "\n layers:";
+    for (const uint64_t &i : m.get_number_nodes())
+        out << ' ' << i;
+    out << "\n activations:";
+    for (const activation_type &i : m.get_activation_functions())
+        out << ' ' << i;
+    out << '\n';
+    return out;
+}
+
+double to_double(const string &s)
+{
+    size_t position = 0;
+    double y = stod(s, &position);
+    if (position != s.size())
+        throw model::not_number();
+    return y;
+}
@@ -1,119 +1,728 @@
-#include <iostream>
-#include <stdexcept>
-#include <vector>
-#include <cmath>
-using namespace std;
-
-// =========
-// Interface
-// =========
-
-class network
-{
-
-public:
-    /**
-    * @brief Construct a new network::network object
-    * 
-    * @param _number_neurons The number of neurons of the network.
-    * @param _number_edges The number of edges of the network.
-    */
-    network(const uint64_t &, const uint64_t &);
-
-    /**
-    * @brief Member function to obtain (but not modify) the number of neurons of the network.
-    * 
-    * @return uint64_t Number of neurons of the network.
-    */
-    uint64_t get_neurons_number() const;
-
-    /**
-    * @brief Member function to obtain (but not modify) the number of edges of the network.
-    * 
-    * @return uint64_t Number of edges of the network.
-    */
-    uint64_t get_edges_number() const;
-
-    /**
-    * @brief Member function to update the delta for all the edges of the network.
-    * 
-    * @param neurons A vector containing all the neurons of the network.
-    * @param edges A vector containing all the edges of the network.
-    */
-    void delta_update(const vector<neuron> &, vector<edge> &);
-
-    /**
-    * @brief Member function to update gradient for all the edges of the network.
-    * 
-    * @param edges A vector containing all the edges of the network.
-    * @param number_instances Number of rows of the dataset.
-    * @param lambda Regularization parameter.
-    */
-    void gradient_update(vector<edge> &, const uint64_t &, const double &);
-
-    /**
-    * @brief Gradient descent algorithm which updates the weights of the edges. 
-    * 
-    * @param edges A vector containing all the edges of the network.
-    * @param learning_rate Learning rate of the gradient descent algorithm.
-    */
-    void gradient_descent(vector<edge> &, const double &);
-
-private:
-    /**
-     * @brief The number of neurons of the network.
-     * 
-     */
-    uint64_t number_neurons = 0;
-
-    /**
-     * @brief The number of edges of the network.
-     * 
-     */
-    uint64_t number_edges = 0;
-};
-
-// ==============
-// Implementation
-// ==============
-
-network::network(const uint64_t &_number_neurons, const uint64_t &_number_edges)
-    : number_neurons(_number_neurons), number_edges(_number_edges)
-{
-}
-
-uint64_t network::get_neurons_number() const
-{
-    return number_neurons;
-}
-
-uint64_t network::get_edges_number() const
-{
-    return number_edges;
-}
-
-void network::delta_update(const vector<neuron> &neurons, vector<edge> &edges)
-{
-    for (edge &i : edges)
-    {
-        double activation = (neuron(0, i.start_layer, i.start_number).find_neuron(neurons)).activation;
-        double error = (neuron(0, i.start_layer + 1, i.end_number).find_neuron(neurons)).error;
-        i.delta += activation * error; // Updating delta using the activation and error values of the neurons related to this edge.
-    }
-}
-
-void network::gradient_update(vector<edge> &edges, const uint64_t &number_instances, const double &lambda)
-{
-    for (edge &i : edges)
-    {
-        i.gradient_edge(number_instances, lambda); // Updating gradient using gradient_edge function.
-    }
-}
-
-void network::gradient_descent(vector<edge> &edges, const double &learning_rate)
-{
-    for (edge &i : edges)
-    {
-        i.weight -= learning_rate * i.gradient;
-    }
-}
\ No newline at end of file
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <cmath>
+#include <atomic>
+#include <algorithm>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+class network
+{
+
+public:
+    /**
+    * @brief Construct a new network::network object
+    * 
+    * @param _number_neurons The number of neurons of the network.
+    * @param _number_edges The number of edges of the network.
+    */
+    network(const uint64_t &, const uint64_t &);
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of neurons of the network.
+    * 
+    * @return uint64_t Number of neurons of the network.
+    */
+    uint64_t get_neurons_number() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of edges of the network.
+    * 
+    * @return uint64_t Number of edges of the network.
+    */
+    uint64_t get_edges_number() const;
+
+    /**
+    * @brief Member function to update the delta for all the edges of the network.
+    * 
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network.
+    */
+    void delta_update(const vector<neuron> &, vector<edge> &);
+
+    /**
+    * @brief Member function to sum the delta of the edges over all the worker processes of data-parallel training, which trained on different shards of the train set. It should be called by all the processes before gradient_update().
+    * 
+    * @param edges A vector containing all the edges of the network.
+    * @param buffer Vector with the size of edges for combining the deltas (Passed to avoid allocating in every iteration).
+    * @param t The transport between the processes.
+    */
+    void delta_allreduce(vector<edge> &, vector<double> &, transport &);
+
+    /**
+    * @brief Member function to update gradient for all the edges of the network.
+    * 
+    * @param edges A vector containing all the edges of the network.
+    * @param number_instances Number of rows of the dataset.
+    * @param lambda Regularization parameter.
+    */
+    void gradient_update(vector<edge> &, const uint64_t &, const double &);
+
+    /**
+    * @brief Gradient descent algorithm which updates the weights of the edges. 
+    * 
+    * @param edges A vector containing all the edges of the network.
+    * @param learning_rate Learning rate of the gradient descent algorithm.
+    */
+    void gradient_descent(vector<edge> &, const double &);
+
+    /**
+    * @brief Member function to set the weights and gradients of the edges, such as from a checkpoint.
+    * 
+    * @param edges A vector containing all the edges of the network.
+    * @param weights Weight of each edge.
+    * @param gradients Gradient of each edge.
+    */
+    void set_weights(vector<edge> &, const vector<double> &, const vector<double> &);
+
+    /**
+    * @brief Member function to set the deltas of the edges, such as the sum of the deltas computed by several threads.
+    * 
+    * @param edges A vector containing all the edges of the network.
+    * @param deltas Delta of each edge.
+    */
+    void set_deltas(vector<edge> &, const vector<double> &);
+
+    /**
+    * @brief Member function to randomly initialize the weights of the edges. Each weight only depends on the ID of its edge, so large networks are divided between the threads of the thread pool and get the same weights.
+    * 
+    * @param edges A vector containing all the edges of the network.
+    * @param number_nodes Vector containing the number of neurons in each layer (Except the bias unit).
+    * @param rng Random number generator of the initial weights.
+    */
+    void initialize_weights(vector<edge> &, const vector<uint64_t> &, const counter_rng &);
+
+    /**
+    * @brief Forward propagation which activates all the layers of the network for an instance.
+    * 
+    * @param layers A vector containing all the layers of the network.
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network.
+    * @param x Feature values of the instance.
+    */
+    void forward_propagation(vector<layer> &, vector<neuron> &, vector<edge> &, vector<double> &);
+
+    /**
+    * @brief Forward propagation of an instance whose feature values are stored in an array, such as a row of a contiguous block of rows.
+    * 
+    * @param layers A vector containing all the layers of the network.
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network.
+    * @param x Feature values of the instance, starting with the bias unit.
+    */
+    void forward_propagation(vector<layer> &, vector<neuron> &, vector<edge> &, const double *);
+
+    /**
+    * @brief Back propagation which calculates the errors of the layers for an instance and adds its share to the delta of the edges. forward_propagation() should be called for the instance first.
+    * 
+    * @param layers A vector containing all the layers of the network.
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network.
+    * @param label The class of the instance (Starting from 1).
+    */
+    void back_propagation(vector<layer> &, vector<neuron> &, vector<edge> &, const uint64_t &);
+
+    /**
+    * @brief Forward and back propagation of an instance with a sampled softmax output layer. Only the output neuron of the class and a number of other output neurons drawn uniformly at random without replacement are computed, and the softmax is normalized over them. The errors of the last hidden layer and the deltas of the output edges only come from the sampled neurons, so the cost of the output layer per instance grows with the number of samples instead of the number of classes. Since the proposal is uniform, the correction of the sampled weighted sums is the same for all the classes and cancels out in the softmax. The output layer should use softmax, and the full softmax is computed by forward_propagation() for evaluation.
+    * 
+    * @param layers A vector containing all the layers of the network.
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network.
+    * @param x Feature values of the instance.
+    * @param label The class of the instance (Starting from 1).
+    * @param rng Random number generator of the sampled classes.
+    * @param counter Counter of the first random number of the instance, which uses number_samples numbers.
+    * @param number_samples Number of sampled classes other than the class of the instance.
+    * @param sampled Vector for the sampled classes. If its capacity is number_samples + 1, nothing is allocated.
+    */
+    void sampled_propagation(vector<layer> &, vector<neuron> &, vector<edge> &, vector<double> &, const uint64_t &, const counter_rng &, const uint64_t &, const uint64_t &, vector<uint64_t> &);
+
+    /**
+    * @brief Forward propagation of an instance with sparse features. The weighted sums of the first hidden layer only add the weights of the non-zero features, and the other layers are activated as usual. The neurons of the input layer are not set.
+    * 
+    * @param layers A vector containing all the layers of the network.
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network.
+    * @param features The non-zero features of the instance (Starting from 1).
+    * @param values The values of these features.
+    * @param count Number of non-zero features.
+    */
+    void sparse_forward_propagation(vector<layer> &, vector<neuron> &, vector<edge> &, const uint64_t *, const double *, const uint64_t &);
+
+    /**
+    * @brief Back propagation of an instance with sparse features. The errors are calculated as usual, but only the edges of the bias unit and of the non-zero features of the input layer get a share of the delta, since the activation of the other input neurons is zero. sparse_forward_propagation() should be called for the instance first.
+    * 
+    * @param layers A vector containing all the layers of the network.
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network.
+    * @param features The non-zero features of the instance (Starting from 1).
+    * @param values The values of these features.
+    * @param count Number of non-zero features.
+    * @param label The class of the instance (Starting from 1).
+    */
+    void sparse_back_propagation(vector<layer> &, vector<neuron> &, vector<edge> &, const uint64_t *, const double *, const uint64_t &, const uint64_t &);
+
+    /**
+    * @brief One epoch of minibatch stochastic gradient descent over a sparse train set in the CSR format. The regularization and the step of a minibatch are the same as those of hogwild_train() with one thread, but a weight of the input layer whose feature is not in a minibatch only decays by 1 - learning_rate * lambda / rows.size(). This decay is applied lazily: the step in which each feature was last updated is saved, and the missed steps are applied at once by a power of the decay when the feature appears again and at the end of the epoch. So each step only updates the weights of the non-zero features of its minibatch and the other layers, and all the weights are up to date when the epoch ends.
+    * 
+    * @param layers A vector containing all the layers of the network.
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network, whose weights are updated.
+    * @param row_offsets The position of the first non-zero value of each row of the dataset, followed by the number of non-zero values.
+    * @param features The feature of each non-zero value (Starting from 1).
+    * @param values The non-zero values.
+    * @param rows The rows of the dataset in the train set, in the order of training.
+    * @param classes The class of each instance of the train set (Starting from 1).
+    * @param batch_size Number of instances of a minibatch.
+    * @param learning_rate Learning rate of the gradient descent algorithm.
+    * @param lambda Regularization parameter.
+    * @param applied_steps Vector with one element per neuron of the input layer for the number of steps applied to each feature (Passed to avoid allocating in every epoch).
+    */
+    void sparse_sgd_epoch(vector<layer> &, vector<neuron> &, vector<edge> &, const vector<uint64_t> &, const vector<uint64_t> &, const vector<double> &, const vector<uint64_t> &, const vector<uint64_t> &, const uint64_t &, const double &, const double &, vector<uint64_t> &);
+
+    /**
+    * @brief Member function to find the predicted class which is the number of the neuron with the maximum activation in the last layer. forward_propagation() should be called for the instance first.
+    * 
+    * @param neurons A vector containing all the neurons of the network.
+    * @param number_layers Number of layers of the network.
+    * @param number_classes Number of neurons of the last layer.
+    * @return uint64_t The predicted class.
+    */
+    uint64_t predict_class(const vector<neuron> &, const uint64_t &, const uint64_t &) const;
+
+    /**
+    * @brief Asynchronous (Hogwild) stochastic gradient descent. The weights are shared by the threads without locks: each thread copies them with relaxed atomic loads, calculates the gradient of a minibatch of its own rows on its own copy of the neurons and edges, and subtracts it from the shared weights with relaxed atomic stores. An update of another thread could be lost, which is the price for not waiting at a barrier after each minibatch. The threads are logical: in each epoch, the parts of the threads are the tasks of a parallel_for() of the thread pool, so no thread is started and the threads only wait for each other at the end of an epoch.
+    * 
+    * @param layers A vector containing all the layers of the network.
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network, whose weights are updated.
+    * @param x Feature values of the train set.
+    * @param classes The class of each instance of the train set (Starting from 1).
+    * @param number_threads Number of logical threads, which divide the minibatches between them.
+    * @param number_epochs Number of passes over the train set.
+    * @param batch_size Number of instances of a minibatch (1 for per-instance updates).
+    * @param learning_rate Learning rate of the gradient descent algorithm.
+    * @param lambda Regularization parameter.
+    */
+    void hogwild_train(const vector<layer> &, const vector<neuron> &, vector<edge> &, vector<vector<double>> &, const vector<uint64_t> &, const uint64_t &, const uint64_t &, const uint64_t &, const double &, const double &);
+
+    /**
+    * @brief Member function to calculate the cost of the network on a dataset (Without regularization), which is used for comparing the convergence of the training modes. The cost is the cross-entropy of the class for a softmax output layer and the logistic cost of each output otherwise.
+    * 
+    * @param layers A vector containing all the layers of the network.
+    * @param neurons A vector containing all the neurons of the network.
+    * @param edges A vector containing all the edges of the network.
+    * @param x Feature values of the dataset.
+    * @param classes The class of each instance (Starting from 1).
+    * @return double The mean cost per instance.
+    */
+    double cost(vector<layer> &, vector<neuron> &, vector<edge> &, vector<vector<double>> &, const vector<uint64_t> &);
+
+private:
+    /**
+    * @brief Member function to multiply the errors of the neurons of a hidden layer by the derivative of their activation function.
+    * 
+    * @tparam Activation Activation policy of the layer.
+    * @param neurons A vector containing all the neurons of the network.
+    * @param layer_neurons The IDs of the neurons of the layer.
+    */
+    template <typename Activation>
+    void scale_errors(vector<neuron> &, const vector<uint64_t> &);
+
+    /**
+     * @brief The number of neurons of the network.
+     * 
+     */
+    uint64_t number_neurons = 0;
+
+    /**
+     * @brief The number of edges of the network.
+     * 
+     */
+    uint64_t number_edges = 0;
+};
+
+/**
+ * @brief Generates the layers, neurons and edges of a network with randomly initialized weights.
+ * 
+ * @param number_nodes Vector containing the number of neurons in each layer (Except the bias unit).
+ * @param activation_functions Activation function of each layer except the input layer.
+ * @param layers Vector in which the layers of the network will be stored.
+ * @param neurons Vector in which the neurons of the network will be stored.
+ * @param edges Vector in which the edges of the network will be stored.
+ * @param rng Random number generator of the initial weights.
+ * @return network The generated network.
+ */
+network generate_network(const vector<uint64_t> &, const vector<activation_type> &, vector<layer> &, vector<neuron> &, vector<edge> &, const counter_rng & = counter_rng());
+
+// ==============
+// Implementation
+// ==============
+
+network::network(const uint64_t &_number_neurons, const uint64_t &_number_edges)
+    : number_neurons(_number_neurons), number_edges(_number_edges)
+{
+}
+
+uint64_t network::get_neurons_number() const
+{
+    return number_neurons;
+}
+
+uint64_t network::get_edges_number() const
+{
+    return number_edges;
+}
+
+void network::delta_update(const vector<neuron> &neurons, vector<edge> &edges)
+{
+    PROFILE_SCOPE(delta);
+    scoped_trace trace_scope("delta");
+    for (edge &i : edges)
+    {
+        double activation = (neuron(0, i.start_layer, i.start_number).find_neuron(neurons)).activation;
+        double error = (neuron(0, i.start_layer + 1, i.end_number).find_neuron(neurons)).error;
+        i.delta += activation * error; // Updating delta using the activation and error values of the neurons related to this edge.
+    }
+}
+
+void network::delta_allreduce(vector<edge> &edges, vector<double> &buffer, transport &t)
+{
+    PROFILE_SCOPE(allreduce);
+    scoped_trace trace_scope("allreduce");
+    for (uint64_t i = 0; i < edges.size(); i++)
+        buffer[i] = edges[i].delta;
+    t.allreduce(buffer.data(), edges.size());
+    for (uint64_t i = 0; i < edges.size(); i++)
+        edges[i].delta = buffer[i];
+}
+
+void network::gradient_update(vector<edge> &edges, const uint64_t &number_instances, const double &lambda)
+{
+    PROFILE_SCOPE(gradient_update);
+    scoped_trace trace_scope("gradient update");
+    for (edge &i : edges)
+    {
+        i.gradient_edge(number_instances, lambda); // Updating gradient using gradient_edge function.
+    }
+}
+
+void network::gradient_descent(vector<edge> &edges, const double &learning_rate)
+{
+    PROFILE_SCOPE(gradient_descent);
+    scoped_trace trace_scope("gradient descent");
+    for (edge &i : edges)
+    {
+        i.weight -= learning_rate * i.gradient;
+    }
+}
+
+void network::set_weights(vector<edge> &edges, const vector<double> &weights, const vector<double> &gradients)
+{
+    for (uint64_t i = 0; i < edges.size(); i++)
+    {
+        edges[i].weight = weights[i];
+        edges[i].gradient = gradients[i];
+    }
+}
+
+void network::set_deltas(vector<edge> &edges, const vector<double> &deltas)
+{
+    for (uint64_t i = 0; i < edges.size(); i++)
+        edges[i].delta = deltas[i];
+}
+
+void network::initialize_weights(vector<edge> &edges, const vector<uint64_t> &number_nodes, const counter_rng &rng)
+{
+    thread_pool::instance().parallel_for(0, edges.size(), 1 << 16, [&](const uint64_t &begin, const uint64_t &end)
+                                         {
+                                             for (uint64_t i = begin; i < end; i++)
+                                                 edges[i].weight_initializer(number_nodes, rng);
+                                         });
+}
+
+void network::forward_propagation(vector<layer> &layers, vector<neuron> &neurons, vector<edge> &edges, vector<double> &x)
+{
+    forward_propagation(layers, neurons, edges, x.data());
+}
+
+void network::forward_propagation(vector<layer> &layers, vector<neuron> &neurons, vector<edge> &edges, const double *x)
+{
+    for (layer &i : layers)
+    {
+        i.activate_layer(neurons, edges, x);
+    }
+}
+
+void network::back_propagation(vector<layer> &layers, vector<neuron> &neurons, vector<edge> &edges, const uint64_t &label)
+{
+    uint64_t number_layers = layers.size();
+
+    // Find the error for layers of NN.
+    for (uint64_t i = number_layers; i > 1; i--)
+    {
+        layers[i - 1].error_layer(neurons, edges, label, number_layers);
+    }
+
+    // Update delta for each edge.
+    delta_update(neurons, edges);
+}
+
+void network::sampled_propagation(vector<layer> &layers, vector<neuron> &neurons, vector<edge> &edges, vector<double> &x, const uint64_t &label, const counter_rng &rng, const uint64_t &counter, const uint64_t &number_samples, vector<uint64_t> &sampled)
+{
+    uint64_t number_layers = layers.size();
+    for (uint64_t i = 0; i + 1 < number_layers; i++)
+        layers[i].activate_layer(neurons, edges, x);
+
+    // The neurons and edges are stored in order of their IDs.
+    const vector<uint64_t> &outputs = layers[number_layers - 1].get_layer_neurons();
+    const vector<uint64_t> &hidden = layers[number_layers - 2].get_layer_neurons(); // Starting with the bias unit, so hidden[h] is neuron number h.
+
+    // The class of the instance and number_samples of the m other classes, drawn without replacement by Floyd's algorithm: for j = m - n + 1, ..., m, a number t in 1, ..., j is drawn, and j is taken instead if t was already taken, so each subset of n classes is equally likely and exactly n classes are drawn with n random numbers. The other classes are numbered 1, ..., m skipping the class of the instance, and are kept sorted. All of them are taken if n covers them.
+    sampled.clear();
+    sampled.push_back(label);
+    uint64_t m = outputs.size() - 1;
+    if (number_samples >= m)
+    {
+        for (uint64_t c = 1; c <= m; c++)
+            sampled.push_back(c);
+    }
+    else
+    {
+        for (uint64_t j = m - number_samples + 1; j <= m; j++)
+        {
+            uint64_t t = 1 + rng.bits(counter + j - (m - number_samples + 1)) % j;
+            vector<uint64_t>::iterator position = lower_bound(sampled.begin() + 1, sampled.end(), t);
+            if (position != sampled.end() && *position == t)
+                sampled.push_back(j); // The numbers taken so far are less than j.
+            else
+                sampled.insert(position, t);
+        }
+    }
+    for (uint64_t s = 1; s < sampled.size(); s++)
+        sampled[s] += sampled[s] < label ? 0 : 1;
+
+    {
+        PROFILE_SCOPE(forward);
+        // Softmax over the sampled output neurons, which subtracts the largest weighted sum before the exponentials.
+        double max_input = -numeric_limits<double>::infinity(), sum = 0;
+        for (const uint64_t &c : sampled)
+        {
+            neuron &o = neurons[outputs[c - 1] - 1];
+            o.activation = o.activate_neuron(neurons, edges);
+            max_input = max(max_input, o.activation);
+        }
+        for (const uint64_t &c : sampled)
+        {
+            neuron &o = neurons[outputs[c - 1] - 1];
+            o.activation = exp(o.activation - max_input);
+            sum += o.activation;
+        }
+        for (const uint64_t &c : sampled)
+        {
+            neuron &o = neurons[outputs[c - 1] - 1];
+            o.activation /= sum;
+            o.error = o.activation - (c == label ? 1 : 0); // The gradient of the cross-entropy over the sampled classes.
+        }
+    }
+
+    {
+        PROFILE_SCOPE(error);
+        // Errors of the last hidden layer from the sampled output neurons, then the other hidden layers as usual.
+        if (number_layers > 2)
+        {
+            for (const uint64_t &ID : hidden)
+                neurons[ID - 1].error = 0;
+            for (const uint64_t &c : sampled)
+            {
+                const neuron &o = neurons[outputs[c - 1] - 1];
+                for (uint64_t h = 1; h < hidden.size(); h++)
+                    neurons[hidden[h] - 1].error += edges[o.input_edges[h] - 1].weight * o.error;
+            }
+            switch (layers[number_layers - 2].get_activation_function())
+            {
+            case activation_type::sigmoid:
+                scale_errors<sigmoid_activation>(neurons, hidden);
+                break;
+            case activation_type::tanh:
+                scale_errors<tanh_activation>(neurons, hidden);
+                break;
+            case activation_type::relu:
+                scale_errors<relu_activation>(neurons, hidden);
+                break;
+            case activation_type::leaky_relu:
+                scale_errors<leaky_relu_activation>(neurons, hidden);
+                break;
+            case activation_type::softmax:
+                scale_errors<softmax_activation>(neurons, hidden);
+                break;
+            }
+        }
+    }
+    for (uint64_t i = number_layers - 2; i > 1; i--)
+        layers[i - 1].error_layer(neurons, edges, label, number_layers);
+
+    PROFILE_SCOPE(delta);
+    // The edges of the hidden layers come before the edges of the output layer.
+    for (edge &i : edges)
+    {
+        if (i.start_layer + 1 >= number_layers)
+            break;
+        i.delta += neurons[layers[i.start_layer - 1].get_layer_neurons()[i.start_number] - 1].activation * neurons[layers[i.start_layer].get_layer_neurons()[i.end_number] - 1].error;
+    }
+    for (const uint64_t &c : sampled)
+    {
+        const neuron &o = neurons[outputs[c - 1] - 1];
+        for (uint64_t h = 0; h < hidden.size(); h++)
+            edges[o.input_edges[h] - 1].delta += neurons[hidden[h] - 1].activation * o.error;
+    }
+}
+
+void network::sparse_forward_propagation(vector<layer> &layers, vector<neuron> &neurons, vector<edge> &edges, const uint64_t *features, const double *values, const uint64_t &count)
+{
+    vector<double> no_features; // The feature values are only used by the input layer, which is skipped.
+    layers[1].activate_sparse_layer(neurons, edges, features, values, count, layers[0].get_layer_neurons().size() - 1);
+    for (uint64_t i = 2; i < layers.size(); i++)
+        layers[i].activate_layer(neurons, edges, no_features);
+}
+
+void network::sparse_back_propagation(vector<layer> &layers, vector<neuron> &neurons, vector<edge> &edges, const uint64_t *features, const double *values, const uint64_t &count, const uint64_t &label)
+{
+    uint64_t number_layers = layers.size();
+    for (uint64_t i = number_layers; i > 1; i--)
+        layers[i - 1].error_layer(neurons, edges, label, number_layers);
+
+    PROFILE_SCOPE(delta);
+    // The input edges of neuron number j of layer 2 are the first edges, (j - 1)(number_features + 1) + k for the features k = 0, 1, ..., number_features.
+    uint64_t number_features = layers[0].get_layer_neurons().size() - 1;
+    const vector<uint64_t> &first_hidden = layers[1].get_layer_neurons();
+    for (uint64_t e = neurons[first_hidden.back() - 1].number * (number_features + 1); e < edges.size(); e++)
+    {
+        // The layers start with the bias unit except the output layer.
+        edge &i = edges[e];
+        uint64_t end_index = i.start_layer + 1 == number_layers ? i.end_number - 1 : i.end_number;
+        i.delta += neurons[layers[i.start_layer - 1].get_layer_neurons()[i.start_number] - 1].activation * neurons[layers[i.start_layer].get_layer_neurons()[end_index] - 1].error;
+    }
+    for (const uint64_t &ID : first_hidden)
+    {
+        const neuron &n = neurons[ID - 1];
+        if (n.number == 0)
+            continue;
+        edge *w = &edges[(n.number - 1) * (number_features + 1)];
+        w[0].delta += n.error;
+        for (uint64_t k = 0; k < count; k++)
+            w[features[k]].delta += values[k] * n.error;
+    }
+}
+
+void network::sparse_sgd_epoch(vector<layer> &layers, vector<neuron> &neurons, vector<edge> &edges, const vector<uint64_t> &row_offsets, const vector<uint64_t> &features, const vector<double> &values, const vector<uint64_t> &rows, const vector<uint64_t> &classes, const uint64_t &batch_size, const double &learning_rate, const double &lambda, vector<uint64_t> &applied_steps)
+{
+    uint64_t number_features = layers[0].get_layer_neurons().size() - 1;
+    uint64_t number_hidden = neurons[layers[1].get_layer_neurons().back() - 1].number; // Number of neurons of layer 2 (Except the bias unit).
+    uint64_t first_edges = number_hidden * (number_features + 1);                       // Number of edges of the input layer.
+    uint64_t number_instances = rows.size();
+    double decay = 1 - learning_rate * lambda / (double)number_instances; // Decay of a weight in a step without its feature.
+
+    // The step of a minibatch of n instances, whose regularization is scaled to the share of the minibatch in the train set.
+    auto update = [&](edge &i, const uint64_t &n)
+    {
+        i.gradient_edge(n, lambda * n / (double)number_instances);
+        i.weight -= learning_rate * i.gradient;
+        i.delta = 0;
+    };
+
+    fill(applied_steps.begin(), applied_steps.end(), 0);
+    for (edge &i : edges)
+        i.set_delta_zero();
+    uint64_t step = 0;
+    for (uint64_t begin = 0; begin < number_instances; begin += batch_size, step++)
+    {
+        uint64_t end = min(begin + batch_size, number_instances);
+
+        // The weights of each feature of the minibatch catch up with the decay of the steps without the feature before they are used by the forward propagation.
+        for (uint64_t t = begin; t < end; t++)
+        {
+            for (uint64_t k = row_offsets[rows[t]]; k < row_offsets[rows[t] + 1]; k++)
+            {
+                uint64_t c = features[k];
+                if (applied_steps[c] == step)
+                    continue;
+                double missed_decay = pow(decay, (double)(step - applied_steps[c]));
+                for (uint64_t j = 0; j < number_hidden; j++)
+                    edges[j * (number_features + 1) + c].weight *= missed_decay;
+                applied_steps[c] = step;
+            }
+        }
+
+        for (uint64_t t = begin; t < end; t++)
+        {
+            uint64_t r = rows[t], count = row_offsets[r + 1] - row_offsets[r];
+            sparse_forward_propagation(layers, neurons, edges, &features[row_offsets[r]], &values[row_offsets[r]], count);
+            sparse_back_propagation(layers, neurons, edges, &features[row_offsets[r]], &values[row_offsets[r]], count, classes[t]);
+        }
+
+        PROFILE_SCOPE(gradient_descent);
+        // The edges of the other layers and of the bias unit of the input layer are updated in every step.
+        for (uint64_t e = first_edges; e < edges.size(); e++)
+            update(edges[e], end - begin);
+        for (uint64_t j = 0; j < number_hidden; j++)
+            update(edges[j * (number_features + 1)], end - begin);
+
+        // The edges of each feature of the minibatch are updated once.
+        for (uint64_t t = begin; t < end; t++)
+        {
+            for (uint64_t k = row_offsets[rows[t]]; k < row_offsets[rows[t] + 1]; k++)
+            {
+                uint64_t c = features[k];
+                if (applied_steps[c] == step + 1)
+                    continue;
+                for (uint64_t j = 0; j < number_hidden; j++)
+                    update(edges[j * (number_features + 1) + c], end - begin);
+                applied_steps[c] = step + 1;
+            }
+        }
+    }
+
+    // The decay of the remaining steps of the epoch.
+    for (uint64_t c = 1; c <= number_features; c++)
+    {
+        if (applied_steps[c] == step)
+            continue;
+        double missed_decay = pow(decay, (double)(step - applied_steps[c]));
+        for (uint64_t j = 0; j < number_hidden; j++)
+            edges[j * (number_features + 1) + c].weight *= missed_decay;
+    }
+}
+
+template <typename Activation>
+void network::scale_errors(vector<neuron> &neurons, const vector<uint64_t> &layer_neurons)
+{
+    for (const uint64_t &ID : layer_neurons)
+    {
+        neuron &i = neurons[ID - 1];
+        if (i.number != 0)
+            i.error *= Activation::derivative(i.activation);
+    }
+}
+
+uint64_t network::predict_class(const vector<neuron> &neurons, const uint64_t &number_layers, const uint64_t &number_classes) const
+{
+    double max_activation = (neuron(0, number_layers, 1).find_neuron(neurons)).get_activation();
+    uint64_t category = 1;
+    // Update the category of the instance.
+    for (uint64_t i = 2; i <= number_classes; i++)
+    {
+        if (((neuron(0, number_layers, i).find_neuron(neurons)).get_activation()) > max_activation)
+        {
+            max_activation = ((neuron(0, number_layers, i).find_neuron(neurons)).get_activation());
+            category = i;
+        }
+    }
+    return category;
+}
+
+void network::hogwild_train(const vector<layer> &layers, const vector<neuron> &neurons, vector<edge> &edges, vector<vector<double>> &x, const vector<uint64_t> &classes, const uint64_t &number_threads, const uint64_t &number_epochs, const uint64_t &batch_size, const double &learning_rate, const double &lambda)
+{
+    vector<atomic<double>> weights(edges.size()); // The shared weights.
+    for (uint64_t i = 0; i < edges.size(); i++)
+        weights[i].store(edges[i].weight, memory_order_relaxed);
+
+    // The copies of the network of the threads, which are made once for all the epochs.
+    vector<vector<layer>> local_layers(number_threads, layers);
+    vector<vector<neuron>> local_neurons(number_threads, neurons);
+    vector<vector<edge>> local_edges(number_threads, edges);
+    for (uint64_t epoch = 0; epoch < number_epochs; epoch++)
+    {
+        thread_pool::instance().parallel_for(0, number_threads, 1, [&](const uint64_t &first, const uint64_t &last)
+                                             {
+                                                 for (uint64_t j = first; j < last; j++)
+                                                 {
+                                                     scoped_trace trace_scope("hogwild", "thread", j + 1);
+                                                     vector<edge> &thread_edges = local_edges[j];
+                                                     // Thread j trains on minibatches j, j + number_threads, ...
+                                                     for (uint64_t begin = j * batch_size; begin < x.size(); begin += number_threads * batch_size)
+                                                     {
+                                                         uint64_t end = min<uint64_t>(begin + batch_size, x.size());
+                                                         for (uint64_t i = 0; i < thread_edges.size(); i++)
+                                                         {
+                                                             thread_edges[i].weight = weights[i].load(memory_order_relaxed);
+                                                             thread_edges[i].set_delta_zero();
+                                                         }
+                                                         for (uint64_t t = begin; t < end; t++)
+                                                         {
+                                                             forward_propagation(local_layers[j], local_neurons[j], thread_edges, x[t]);
+                                                             back_propagation(local_layers[j], local_neurons[j], thread_edges, classes[t]);
+                                                         }
+                                                         // The regularization is scaled to the share of the minibatch in the train set.
+                                                         for (uint64_t i = 0; i < thread_edges.size(); i++)
+                                                         {
+                                                             thread_edges[i].gradient_edge(end - begin, lambda * (end - begin) / (double)x.size());
+                                                             weights[i].store(weights[i].load(memory_order_relaxed) - learning_rate * thread_edges[i].gradient, memory_order_relaxed);
+                                                         }
+                                                     }
+                                                 } });
+    }
+
+    for (uint64_t i = 0; i < edges.size(); i++)
+        edges[i].weight = weights[i].load(memory_order_relaxed);
+}
+
+double network::cost(vector<layer> &layers, vector<neuron> &neurons, vector<edge> &edges, vector<vector<double>> &x, const vector<uint64_t> &classes)
+{
+    // The costs of the instances are added by a pairwise tree, so the cost does not depend on the order of the additions.
+    vector<double> costs(x.size(), 0);
+    bool softmax_output = layers.back().get_activation_function() == activation_type::softmax;
+    for (uint64_t t = 0; t < x.size(); t++)
+    {
+        forward_propagation(layers, neurons, edges, x[t]);
+        for (const neuron &i : neurons)
+        {
+            if (i.layer == layers.size())
+            {
+                double h = min(max(i.activation, 1e-15), 1 - 1e-15);
+                if (softmax_output)
+                    costs[t] -= i.number == classes[t] ? log(h) : 0;
+                else
+                    costs[t] -= i.number == classes[t] ? log(h) : log(1 - h);
+            }
+        }
+    }
+    return pairwise_sum(costs.data(), costs.size()) / (double)x.size();
+}
+
+network generate_network(const vector<uint64_t> &number_nodes, const vector<activation_type> &activation_functions, vector<layer> &layers, vector<neuron> &neurons, vector<edge> &edges, const counter_rng &rng)
+{
+    PROFILE_SCOPE(construction);
+    scoped_trace trace_scope("construction");
+    uint64_t ID = 0; // Counter for edge or neuron ID.
+
+    // Generating layers and their neurons.
+    for (uint64_t i = 1; i <= number_nodes.size(); i++)
+    {
+        layer l(i, i > 1 ? activation_functions[i - 2] : activation_type::sigmoid);
+        l.gen_layer_neurons(number_nodes, neurons, ID);
+        layers.push_back(l);
+    }
+
+    ID = 0;
+
+    // Generating input edges for each neuron.
+    for (neuron &i : neurons)
+    {
+        i.gen_input_edges(number_nodes, edges, ID);
+    }
+
+    // Generating output edges for each neuron.
+    for (neuron &i : neurons)
+    {
+        i.gen_output_edges(number_nodes, edges);
+    }
+
+    network N(neurons.size(), edges.size());
+    N.initialize_weights(edges, number_nodes, rng);
+    return N;
+}
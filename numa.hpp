@@ -0,0 +1,296 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdint>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief Size of a transparent huge page on x86-64 and most Linux systems.
+ *
+ */
+constexpr uint64_t huge_page_size = 2 << 20;
+
+/**
+ * @brief The NUMA nodes of the machine and their CPUs, read from /sys/devices/system/node on Linux. On other systems, or if the nodes are not listed, all the CPUs are on node 0. The threads are placed compactly: thread t runs on the t-th CPU when the CPUs are listed node after node, so the threads only use the next node when the previous one is full.
+ *
+ */
+class numa_topology
+{
+
+public:
+    /**
+    * @brief Construct a new numa topology::numa topology object from the nodes of the machine.
+    *
+    */
+    numa_topology();
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of nodes.
+    *
+    * @return uint64_t Number of nodes.
+    */
+    uint64_t get_nodes() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the CPU of a thread.
+    *
+    * @param t Number of the thread.
+    * @return uint64_t The CPU.
+    */
+    uint64_t cpu_of_thread(const uint64_t &) const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the node of a thread.
+    *
+    * @param t Number of the thread.
+    * @return uint64_t The node of the CPU of the thread.
+    */
+    uint64_t node_of_thread(const uint64_t &) const;
+
+private:
+    /**
+     * @brief All the CPUs, listed node after node.
+     *
+     */
+    vector<uint64_t> cpus;
+
+    /**
+     * @brief The node of each CPU of cpus.
+     *
+     */
+    vector<uint64_t> cpu_nodes;
+
+    /**
+     * @brief Number of nodes.
+     *
+     */
+    uint64_t nodes = 1;
+};
+
+/**
+ * @brief Reading a list of CPUs in the format of /sys/devices/system/node/node*\/cpulist, such as "0-3,8-11".
+ *
+ * @param s The list.
+ * @return vector<uint64_t> The CPUs.
+ */
+vector<uint64_t> parse_cpu_list(const string &);
+
+/**
+ * @brief Pinning the calling thread to a CPU, so its memory is allocated on the node of the CPU by the first-touch policy of Linux and its caches are not lost when it moves (Nothing is done on other systems). Nothing is allocated, so a task could pin its thread in the training loop.
+ *
+ * @param cpu The CPU.
+ * @return bool If the thread was pinned.
+ */
+bool pin_thread(const uint64_t &);
+
+/**
+ * @brief Finding the CPUs which the calling thread is allowed to run on.
+ *
+ * @return vector<uint64_t> The CPUs (Empty if they are not known).
+ */
+vector<uint64_t> thread_affinity();
+
+/**
+ * @brief Allowing the calling thread to run on a set of CPUs, such as the CPUs it had before it was pinned.
+ *
+ * @param cpus The CPUs (Nothing is done if it is empty).
+ * @return bool If the CPUs of the thread were set.
+ */
+bool set_thread_affinity(const vector<uint64_t> &);
+
+/**
+ * @brief Asking Linux to back the 2 MiB aligned pages of an array with transparent huge pages, so a large array needs fewer TLB entries. The pages are only replaced when they are touched or by khugepaged, and nothing is done if transparent huge pages are disabled (or on other systems).
+ *
+ * @param data The array.
+ * @param bytes Size of the array in bytes.
+ */
+void advise_huge_pages(void *, const uint64_t &);
+
+/**
+ * @brief Finding the node of the memory of an address with the get_mempolicy system call.
+ *
+ * @param data The address, which should have been touched.
+ * @return int64_t The node (-1 if it is not known).
+ */
+int64_t node_of_address(const void *);
+
+/**
+ * @brief Number of bytes of an array which are not on a node, found by the node of each page.
+ *
+ * @param data The array.
+ * @param bytes Size of the array in bytes.
+ * @param node The node.
+ * @return uint64_t Number of bytes on the other nodes (0 if the nodes of the pages are not known).
+ */
+uint64_t bytes_on_other_nodes(const void *, const uint64_t &, const uint64_t &);
+
+// ==============
+// Implementation
+// ==============
+
+numa_topology::numa_topology()
+{
+#ifdef __linux__
+    for (uint64_t node = 0;; node++)
+    {
+        ifstream input("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+        if (!input.is_open())
+            break;
+        string s;
+        getline(input, s);
+        for (const uint64_t &cpu : parse_cpu_list(s))
+        {
+            cpus.push_back(cpu);
+            cpu_nodes.push_back(node);
+        }
+        nodes = node + 1;
+    }
+#endif
+    if (cpus.empty())
+    {
+        nodes = 1;
+        for (uint64_t cpu = 0; cpu < max<uint64_t>(thread::hardware_concurrency(), 1); cpu++)
+        {
+            cpus.push_back(cpu);
+            cpu_nodes.push_back(0);
+        }
+    }
+}
+
+uint64_t numa_topology::get_nodes() const
+{
+    return nodes;
+}
+
+uint64_t numa_topology::cpu_of_thread(const uint64_t &t) const
+{
+    return cpus[t % cpus.size()];
+}
+
+uint64_t numa_topology::node_of_thread(const uint64_t &t) const
+{
+    return cpu_nodes[t % cpus.size()];
+}
+
+vector<uint64_t> parse_cpu_list(const string &s)
+{
+    vector<uint64_t> cpus;
+    string range;
+    istringstream string_stream(s);
+    while (getline(string_stream, range, ','))
+    {
+        if (range.empty())
+            continue;
+        size_t dash = range.find('-');
+        uint64_t first = stoull(range.substr(0, dash));
+        uint64_t last = dash == string::npos ? first : stoull(range.substr(dash + 1));
+        for (uint64_t cpu = first; cpu <= last; cpu++)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+bool pin_thread(const uint64_t &cpu)
+{
+#ifdef __linux__
+    if (cpu >= CPU_SETSIZE)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+vector<uint64_t> thread_affinity()
+{
+    vector<uint64_t> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+    {
+        for (uint64_t cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &set))
+                cpus.push_back(cpu);
+        }
+    }
+#endif
+    return cpus;
+}
+
+bool set_thread_affinity(const vector<uint64_t> &cpus)
+{
+#ifdef __linux__
+    if (cpus.empty())
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (const uint64_t &cpu : cpus)
+    {
+        if (cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+void advise_huge_pages(void *data, const uint64_t &bytes)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    uintptr_t begin = ((uintptr_t)data + huge_page_size - 1) / huge_page_size * huge_page_size;
+    uintptr_t end = ((uintptr_t)data + bytes) / huge_page_size * huge_page_size;
+    if (begin < end)
+        madvise((void *)begin, end - begin, MADV_HUGEPAGE);
+#else
+    (void)data;
+    (void)bytes;
+#endif
+}
+
+int64_t node_of_address(const void *data)
+{
+#if defined(__linux__) && defined(SYS_get_mempolicy)
+    int node = -1;
+    const unsigned long node_flag = 1, address_flag = 2; // MPOL_F_NODE and MPOL_F_ADDR of numaif.h.
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0, data, node_flag | address_flag) == 0)
+        return node;
+#else
+    (void)data;
+#endif
+    return -1;
+}
+
+uint64_t bytes_on_other_nodes(const void *data, const uint64_t &bytes, const uint64_t &node)
+{
+    const uint64_t page_size = 4096;
+    uint64_t remote = 0;
+    for (uint64_t offset = 0; offset < bytes; offset += page_size)
+    {
+        int64_t page_node = node_of_address((const char *)data + offset);
+        if (page_node >= 0 && (uint64_t)page_node != node)
+            remote += min(page_size, bytes - offset);
+    }
+    return remote;
+}
@@ -0,0 +1,275 @@
+#include <iostream>
+#include <vector>
+#include <array>
+#include <cstring>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief The hardware events which are counted.
+ *
+ */
+enum class hardware_event
+{
+    cycles,
+    instructions,
+    l1d_misses,
+    llc_misses,
+    branch_misses,
+    number_events
+};
+
+/**
+ * @brief Hardware performance counters of the CPU read with the Linux perf_event_open system call. Each event is opened separately, so an event which is not supported by the CPU (or a virtual machine) does not stop the others from being counted.
+ *
+ */
+class perf_counters
+{
+
+public:
+    /**
+    * @brief Construct a new perf counters::perf counters object and open the counters for the calling thread. The counters are disabled until start() is called.
+    *
+    */
+    perf_counters();
+
+    /**
+    * @brief Destroy the perf counters::perf counters object and close the counters.
+    *
+    */
+    ~perf_counters();
+
+    perf_counters(const perf_counters &) = delete;
+    perf_counters &operator=(const perf_counters &) = delete;
+
+    /**
+    * @brief Member function to check if at least one counter could be opened.
+    *
+    * @return true If the counters are available.
+    * @return false If perf_event_open is not allowed or not supported.
+    */
+    bool available() const;
+
+    /**
+    * @brief Member function to check if an event could be opened.
+    *
+    * @param e The event.
+    * @return true If the event is counted.
+    * @return false If the event is not supported.
+    */
+    bool available(const hardware_event &) const;
+
+    /**
+    * @brief Member function to enable the counters.
+    *
+    */
+    void start();
+
+    /**
+    * @brief Member function to disable the counters and add their values since start() to the totals.
+    *
+    */
+    void stop();
+
+    /**
+    * @brief Member function to set the totals to zero.
+    *
+    */
+    void reset();
+
+    /**
+    * @brief Member function to obtain (but not modify) the total count of an event. If the kernel multiplexed the counters, the count is scaled by the time the event was enabled over the time it was running.
+    *
+    * @param e The event.
+    * @return double Total count of the event.
+    */
+    double get_count(const hardware_event &) const;
+
+    /**
+    * @brief Member function to print the counts, the instructions per cycle, and the counts and bytes moved from the memory per item. Bytes moved are estimated as the last level cache misses times the 64 byte cache line.
+    *
+    * @param out Output stream.
+    * @param items Number of items (instances) which were processed.
+    * @param item_name Name of the items.
+    */
+    void print(ostream &, const uint64_t &, const string &) const;
+
+private:
+    /**
+     * @brief File descriptor of each event (-1 if the event could not be opened).
+     *
+     */
+    array<int, (size_t)hardware_event::number_events> fd;
+
+    /**
+     * @brief Total count of each event.
+     *
+     */
+    array<double, (size_t)hardware_event::number_events> totals{};
+};
+
+/**
+ * @brief Name of an event.
+ *
+ * @param e The event.
+ * @return const char* The name.
+ */
+const char *hardware_event_name(const hardware_event &);
+
+// ==============
+// Implementation
+// ==============
+
+perf_counters::perf_counters()
+{
+    fd.fill(-1);
+#ifdef __linux__
+    for (size_t i = 0; i < fd.size(); i++)
+    {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        switch ((hardware_event)i)
+        {
+        case hardware_event::cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case hardware_event::instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case hardware_event::l1d_misses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case hardware_event::llc_misses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case hardware_event::branch_misses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        default:
+            break;
+        }
+        fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0); // The calling thread on any CPU.
+    }
+#endif
+}
+
+perf_counters::~perf_counters()
+{
+#ifdef __linux__
+    for (const int &i : fd)
+    {
+        if (i >= 0)
+            close(i);
+    }
+#endif
+}
+
+bool perf_counters::available() const
+{
+    for (size_t i = 0; i < fd.size(); i++)
+    {
+        if (fd[i] >= 0)
+            return true;
+    }
+    return false;
+}
+
+bool perf_counters::available(const hardware_event &e) const
+{
+    return fd[(size_t)e] >= 0;
+}
+
+void perf_counters::start()
+{
+#ifdef __linux__
+    for (const int &i : fd)
+    {
+        if (i >= 0)
+        {
+            ioctl(i, PERF_EVENT_IOC_RESET, 0);
+            ioctl(i, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+void perf_counters::stop()
+{
+#ifdef __linux__
+    for (size_t i = 0; i < fd.size(); i++)
+    {
+        if (fd[i] < 0)
+            continue;
+        ioctl(fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t values[3] = {0, 0, 0}; // Count, time enabled and time running.
+        if (read(fd[i], values, sizeof(values)) == sizeof(values) && values[2] > 0)
+            totals[i] += (double)values[0] * (double)values[1] / (double)values[2];
+    }
+#endif
+}
+
+void perf_counters::reset()
+{
+    totals.fill(0);
+}
+
+double perf_counters::get_count(const hardware_event &e) const
+{
+    return totals[(size_t)e];
+}
+
+void perf_counters::print(ostream &out, const uint64_t &items, const string &item_name) const
+{
+    if (!available())
+    {
+        out << "Hardware counters are not available (perf_event_open is not allowed or not supported).\n";
+        return;
+    }
+    for (size_t i = 0; i < fd.size(); i++)
+    {
+        if (fd[i] >= 0)
+            out << hardware_event_name((hardware_event)i) << ": " << totals[i] << " (" << totals[i] / (double)items << " per " << item_name << ")\n";
+    }
+    if (available(hardware_event::cycles) && available(hardware_event::instructions) && get_count(hardware_event::cycles) > 0)
+        out << "IPC: " << get_count(hardware_event::instructions) / get_count(hardware_event::cycles) << '\n';
+    if (available(hardware_event::llc_misses))
+        out << "Bytes moved per " << item_name << ": " << get_count(hardware_event::llc_misses) * 64 / (double)items << '\n';
+}
+
+const char *hardware_event_name(const hardware_event &e)
+{
+    switch (e)
+    {
+    case hardware_event::cycles:
+        return "cycles";
+    case hardware_event::instructions:
+        return "instructions";
+    case hardware_event::l1d_misses:
+        return "L1D misses";
+    case hardware_event::llc_misses:
+        return "LLC misses";
+    case hardware_event::branch_misses:
+        return "branch misses";
+    default:
+        return "";
+    }
+}
@@ -0,0 +1,249 @@
+/**
+ * @file predict.cpp
+ * @brief Batch scoring of a feature file of any size with a trained model.
+ *
+ * Streams a CSV file in the format of x.csv through a model saved by main --save-model and writes the predicted class of each row, optionally followed by the activations of the output layer. Parsing, the forward pass and formatting run as three concurrent stages connected by bounded queues, and a fixed set of batches circulates between the stages, so the memory does not grow with the size of the file.
+ *
+ * Usage: predict model.csv x.csv [--output predictions.csv] [--probabilities] [--batch 1024] [--queue 4]
+ *
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <random>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <charconv>
+#include "activation.hpp"
+#include "thread_pool.hpp"
+#include "counter_rng.hpp"
+#include "edge.hpp"
+#include "standardization.hpp"
+#include "gemm.hpp"
+#include "model.hpp"
+#include "bounded_queue.hpp"
+
+using namespace std;
+
+/**
+ * @brief Rows of the file which move through the stages together.
+ *
+ */
+struct batch
+{
+     vector<double> x;  // Feature values stored row by row.
+     vector<double> y;  // Activations of the output layer stored row by row.
+     uint64_t rows = 0; // Number of rows.
+};
+
+/**
+ * @brief Size of the buffer for writing the predictions.
+ *
+ */
+constexpr uint64_t buffer_size = 1 << 20;
+
+/**
+ * @brief Parsing stage: reading the rows of the file into the free batches.
+ *
+ * @param input The feature file.
+ * @param filename Name of the feature file.
+ * @param features Number of features of the model.
+ * @param free_batches Batches which could be filled.
+ * @param parsed Batches which were filled.
+ * @param error Error message if a line could not be parsed (Empty otherwise).
+ */
+void parse_stage(istream &input, const string &filename, const uint64_t features, bounded_queue<batch *> &free_batches, bounded_queue<batch *> &parsed, string &error)
+{
+     string line;
+     uint64_t line_number = 0;
+     batch *b = nullptr;
+     while (true)
+     {
+          if (b == nullptr)
+          {
+               if (!free_batches.pop(b))
+                    break;
+               b->rows = 0;
+          }
+          if (!getline(input, line))
+               break;
+          line_number++;
+          if (!line.empty() && line.back() == '\r')
+               line.pop_back();
+          if (line.empty())
+               continue;
+
+          // Parsing the comma-separated values without creating a string for each value.
+          const char *p = line.data(), *end = line.data() + line.size();
+          double *row = &b->x[b->rows * features];
+          uint64_t k = 0;
+          for (; k < features && p < end; k++)
+          {
+               while (p < end && *p == ' ')
+                    p++;
+               from_chars_result result = from_chars(p, end, row[k]);
+               if (result.ec != errc())
+                    break;
+               p = result.ptr;
+               while (p < end && *p == ' ')
+                    p++;
+               if (p < end && *p == ',' && k + 1 < features)
+                    p++;
+          }
+          if (k != features || p != end)
+          {
+               error = "Error in line " + to_string(line_number) + " " + filename + ": Expected " + to_string(features) + " numbers separated by commas!";
+               break;
+          }
+
+          if (++b->rows * features == b->x.size())
+          {
+               parsed.push(b);
+               b = nullptr;
+          }
+     }
+     if (b != nullptr && b->rows > 0 && error.empty())
+          parsed.push(b);
+     parsed.close();
+}
+
+/**
+ * @brief Forward stage: running the parsed batches through the model.
+ *
+ * @param m The model.
+ * @param parsed Batches which were filled.
+ * @param computed Batches whose outputs were computed.
+ */
+void forward_stage(const model &m, bounded_queue<batch *> &parsed, bounded_queue<batch *> &computed)
+{
+     vector<double> workspace;
+     batch *b = nullptr;
+     while (parsed.pop(b))
+     {
+          m.forward_batch(b->x.data(), b->rows, b->y.data(), workspace);
+          computed.push(b);
+     }
+     computed.close();
+}
+
+int main(int argc, char *argv[])
+{
+     try
+     {
+          // Reading the command line options.
+          if (argc < 3)
+          {
+               cout << "Usage: " << argv[0] << " model.csv x.csv [--output predictions.csv] [--probabilities] [--batch 1024] [--queue 4]\n";
+               return -1;
+          }
+          string output_filename; // Standard output if empty.
+          bool probabilities = false;
+          uint64_t batch_rows = 1024;
+          uint64_t queue_size = 4;
+          for (int i = 3; i < argc; i++)
+          {
+               string option = argv[i];
+               if (option == "--output" && i + 1 < argc)
+                    output_filename = argv[++i];
+               else if (option == "--probabilities")
+                    probabilities = true;
+               else if (option == "--batch" && i + 1 < argc)
+                    batch_rows = max<uint64_t>(stoull(argv[++i]), 1);
+               else if (option == "--queue" && i + 1 < argc)
+                    queue_size = max<uint64_t>(stoull(argv[++i]), 1);
+               else
+               {
+                    cout << "Usage: " << argv[0] << " model.csv x.csv [--output predictions.csv] [--probabilities] [--batch 1024] [--queue 4]\n";
+                    return -1;
+               }
+          }
+
+          // Reading the trained model.
+          model m(argv[1]);
+          uint64_t features = m.get_number_nodes().front(), outputs = m.get_number_nodes().back();
+
+          string input_filename = argv[2];
+          ifstream input(input_filename, ios::binary);
+          if (!input.is_open())
+          {
+               cout << "Error opening " << input_filename << " input file!";
+               return -1;
+          }
+          ofstream output_file;
+          if (!output_filename.empty())
+          {
+               output_file.open(output_filename, ios::binary);
+               if (!output_file.is_open())
+               {
+                    cout << "Error opening " << output_filename << " output file!";
+                    return -1;
+               }
+          }
+          ostream &output = output_filename.empty() ? cout : output_file;
+
+          // The batches circulate from the free queue through the stages and back. Each queue could hold all of them, so a push never waits for a full queue while the stages are stopping.
+          uint64_t number_batches = 2 * queue_size + 3;
+          vector<batch> batches(number_batches);
+          bounded_queue<batch *> free_batches(number_batches), parsed(number_batches), computed(number_batches);
+          for (batch &b : batches)
+          {
+               b.x.resize(batch_rows * features);
+               b.y.resize(batch_rows * outputs);
+               free_batches.push(&b);
+          }
+
+          chrono::steady_clock::time_point start = chrono::steady_clock::now();
+          string error;
+          thread parser(parse_stage, ref(input), cref(input_filename), features, ref(free_batches), ref(parsed), ref(error));
+          thread forward(forward_stage, cref(m), ref(parsed), ref(computed));
+
+          // Formatting stage in this thread: the predictions are written into a buffer which is written to the output when it is almost full.
+          vector<char> buffer(buffer_size);
+          uint64_t length = 0, rows = 0;
+          uint64_t line_length = 32 + (probabilities ? outputs * 32 : 0); // Upper bound of the length of a line.
+          batch *b = nullptr;
+          while (computed.pop(b))
+          {
+               for (uint64_t r = 0; r < b->rows; r++)
+               {
+                    if (length + line_length > buffer.size())
+                    {
+                         output.write(buffer.data(), length);
+                         length = 0;
+                    }
+                    const double *y = &b->y[r * outputs];
+                    length = to_chars(buffer.data() + length, buffer.data() + buffer.size(), m.predict(y)).ptr - buffer.data();
+                    if (probabilities)
+                    {
+                         for (uint64_t j = 0; j < outputs; j++)
+                         {
+                              buffer[length++] = ',';
+                              length = to_chars(buffer.data() + length, buffer.data() + buffer.size(), y[j], chars_format::fixed, 6).ptr - buffer.data();
+                         }
+                    }
+                    buffer[length++] = '\n';
+               }
+               rows += b->rows;
+               free_batches.push(b);
+          }
+          output.write(buffer.data(), length);
+          output.flush();
+          free_batches.close();
+          parser.join();
+          forward.join();
+          if (!error.empty())
+          {
+               cout << error << '\n';
+               return -1;
+          }
+
+          double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+          cerr << "Scored " << rows << " rows in " << seconds << " s (" << rows / seconds << " rows/s)\n";
+     }
+     catch (const exception &e)
+     {
+          return -1;
+     }
+}
@@ -0,0 +1,424 @@
+#include <iostream>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief The phases of a run which are timed by the profiler.
+ *
+ */
+enum class profile_phase
+{
+    csv_load,
+    split,
+    construction,
+    forward,
+    error,
+    delta,
+    allreduce,
+    gradient_update,
+    gradient_descent,
+    checkpoint,
+    evaluation,
+    number_phases
+};
+
+/**
+ * @brief The quantities which are counted by the profiler.
+ *
+ */
+enum class profile_counter
+{
+    rows_loaded,
+    instances_trained,
+    instances_evaluated,
+    iterations,
+    number_counters
+};
+
+class profiler
+{
+
+public:
+    /**
+    * @brief Static member function to obtain the profiler shared by the whole program.
+    *
+    * @return profiler& The profiler.
+    */
+    static profiler &instance();
+
+    /**
+    * @brief Member function to add the time spent in a phase.
+    *
+    * @param p The phase.
+    * @param ns Time in nanoseconds.
+    */
+    void add_time(const profile_phase &, const uint64_t &);
+
+    /**
+    * @brief Member function to increase a counter.
+    *
+    * @param c The counter.
+    * @param n The increase.
+    */
+    void add_count(const profile_counter &, const uint64_t &);
+
+    /**
+    * @brief Member function to count an allocation of the calling thread in its current phase. It is called by the operator new of alloc_tracker.hpp.
+    *
+    * @param bytes Size of the allocation.
+    */
+    void add_allocation(const uint64_t &);
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of allocations of all the phases so far.
+    *
+    * @return uint64_t Number of allocations.
+    */
+    uint64_t get_allocations() const;
+
+    /**
+    * @brief Static member function to obtain the current phase of the calling thread, which is set by scoped_timer.
+    *
+    * @return profile_phase& The current phase (number_phases outside of all the phases).
+    */
+    static profile_phase &current_phase();
+
+    /**
+    * @brief Member function to mark the end of a training iteration. The time spent in each phase since the previous call is saved as one sample for the percentiles.
+    *
+    */
+    void end_iteration();
+
+    /**
+    * @brief Member function to print the total, mean, p50 and p99 time of each phase per iteration and the counters. With allocation tracking, the allocations and bytes of each phase in total and per iteration are printed as well.
+    *
+    * @param out Output stream.
+    */
+    void print_summary(ostream &);
+
+    /**
+    * @brief Member function to write the same summary as print_summary() in JSON.
+    *
+    * @param out Output stream.
+    */
+    void write_json(ostream &);
+
+private:
+    /**
+     * @brief Total time spent in each phase in nanoseconds.
+     *
+     */
+    array<atomic<uint64_t>, (size_t)profile_phase::number_phases> total_ns{};
+
+    /**
+     * @brief Number of times each phase was timed.
+     *
+     */
+    array<atomic<uint64_t>, (size_t)profile_phase::number_phases> calls{};
+
+    /**
+     * @brief Time spent in each phase since the last end_iteration() in nanoseconds.
+     *
+     */
+    array<atomic<uint64_t>, (size_t)profile_phase::number_phases> pending_ns{};
+
+    /**
+     * @brief Time spent in each phase for each iteration in nanoseconds.
+     *
+     */
+    array<vector<uint64_t>, (size_t)profile_phase::number_phases> samples;
+
+    /**
+     * @brief The counters.
+     *
+     */
+    array<atomic<uint64_t>, (size_t)profile_counter::number_counters> counters{};
+
+    /**
+     * @brief Number of allocations of each phase. The last element is for the allocations outside of all the phases.
+     *
+     */
+    array<atomic<uint64_t>, (size_t)profile_phase::number_phases + 1> allocations{};
+
+    /**
+     * @brief Bytes allocated in each phase. The last element is for the allocations outside of all the phases.
+     *
+     */
+    array<atomic<uint64_t>, (size_t)profile_phase::number_phases + 1> allocated_bytes{};
+
+    /**
+     * @brief Number of iterations ended by end_iteration().
+     *
+     */
+    uint64_t iterations = 0;
+};
+
+/**
+ * @brief Timer which adds the time from its construction to its destruction to a phase of the profiler.
+ *
+ */
+class scoped_timer
+{
+
+public:
+    /**
+    * @brief Construct a new scoped timer::scoped timer object and start the timer.
+    *
+    * @param _p The phase.
+    */
+    scoped_timer(const profile_phase &);
+
+    /**
+    * @brief Destroy the scoped timer::scoped timer object, add the elapsed time to the profiler and restore the previous phase of the thread.
+    *
+    */
+    ~scoped_timer();
+
+private:
+    /**
+     * @brief The phase.
+     *
+     */
+    profile_phase p;
+
+    /**
+     * @brief The phase of the thread before the timer started.
+     *
+     */
+    profile_phase previous;
+
+    /**
+     * @brief The time when the timer started.
+     *
+     */
+    chrono::steady_clock::time_point start;
+};
+
+/**
+ * @brief Name of a phase.
+ *
+ * @param p The phase.
+ * @return const char* The name.
+ */
+const char *profile_phase_name(const profile_phase &);
+
+/**
+ * @brief Name of a counter.
+ *
+ * @param c The counter.
+ * @return const char* The name.
+ */
+const char *profile_counter_name(const profile_counter &);
+
+/**
+ * @brief If the allocations are counted (compiled with -DNN_TRACK_ALLOC).
+ *
+ */
+#ifdef NN_TRACK_ALLOC
+constexpr bool track_allocations = true;
+#else
+constexpr bool track_allocations = false;
+#endif
+
+// The profiler is only compiled in with -DNN_PROFILE (or -DNN_TRACK_ALLOC, which needs the phases). Otherwise, the macros are empty and have no overhead.
+#if defined(NN_PROFILE) || defined(NN_TRACK_ALLOC)
+#define PROFILE_SCOPE(p) scoped_timer profile_scope_timer(profile_phase::p)
+#define PROFILE_COUNT(c, n) profiler::instance().add_count(profile_counter::c, n)
+#define PROFILE_END_ITERATION() profiler::instance().end_iteration()
+#else
+#define PROFILE_SCOPE(p)
+#define PROFILE_COUNT(c, n)
+#define PROFILE_END_ITERATION()
+#endif
+
+// ==============
+// Implementation
+// ==============
+
+profiler &profiler::instance()
+{
+    static profiler p;
+    return p;
+}
+
+void profiler::add_time(const profile_phase &p, const uint64_t &ns)
+{
+    total_ns[(size_t)p].fetch_add(ns, memory_order_relaxed);
+    pending_ns[(size_t)p].fetch_add(ns, memory_order_relaxed);
+    calls[(size_t)p].fetch_add(1, memory_order_relaxed);
+}
+
+void profiler::add_count(const profile_counter &c, const uint64_t &n)
+{
+    counters[(size_t)c].fetch_add(n, memory_order_relaxed);
+}
+
+void profiler::add_allocation(const uint64_t &bytes)
+{
+    allocations[(size_t)current_phase()].fetch_add(1, memory_order_relaxed);
+    allocated_bytes[(size_t)current_phase()].fetch_add(bytes, memory_order_relaxed);
+}
+
+uint64_t profiler::get_allocations() const
+{
+    uint64_t total = 0;
+    for (const atomic<uint64_t> &i : allocations)
+        total += i.load(memory_order_relaxed);
+    return total;
+}
+
+profile_phase &profiler::current_phase()
+{
+    // Trivially constructed, so it does not allocate when it is first used inside operator new.
+    thread_local profile_phase p = profile_phase::number_phases;
+    return p;
+}
+
+void profiler::end_iteration()
+{
+    iterations++;
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        uint64_t ns = pending_ns[i].exchange(0, memory_order_relaxed);
+        if (ns > 0)
+            samples[i].push_back(ns);
+    }
+}
+
+void profiler::print_summary(ostream &out)
+{
+    end_iteration(); // Phases after the last iteration, such as the evaluation.
+    out << "\n\nPhase summary (ms):\n";
+    out << "phase\tcalls\ttotal\tmean\tp50\tp99\n";
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        if (samples[i].empty())
+            continue;
+        vector<uint64_t> sorted = samples[i];
+        sort(sorted.begin(), sorted.end());
+        out << profile_phase_name((profile_phase)i) << '\t' << calls[i] << '\t' << total_ns[i] / 1e6
+            << '\t' << total_ns[i] / 1e6 / (double)sorted.size()
+            << '\t' << sorted[sorted.size() / 2] / 1e6
+            << '\t' << sorted[min(sorted.size() - 1, sorted.size() * 99 / 100)] / 1e6 << '\n';
+    }
+    for (size_t i = 0; i < counters.size(); i++)
+        out << profile_counter_name((profile_counter)i) << ": " << counters[i] << '\n';
+    if (!track_allocations)
+        return;
+    out << "\nAllocations:\n";
+    out << "phase\tallocations\tbytes\tallocations per iteration\tbytes per iteration\n";
+    for (size_t i = 0; i < allocations.size(); i++)
+    {
+        if (allocations[i] == 0)
+            continue;
+        out << (i < samples.size() ? profile_phase_name((profile_phase)i) : "other") << '\t' << allocations[i] << '\t' << allocated_bytes[i]
+            << '\t' << allocations[i] / (double)max<uint64_t>(iterations, 1) << '\t' << allocated_bytes[i] / (double)max<uint64_t>(iterations, 1) << '\n';
+    }
+}
+
+void profiler::write_json(ostream &out)
+{
+    end_iteration();
+    out << "{\n  \"phases\": [\n";
+    bool first = true;
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        if (samples[i].empty())
+            continue;
+        vector<uint64_t> sorted = samples[i];
+        sort(sorted.begin(), sorted.end());
+        out << (first ? "" : ",\n") << "    {\"name\": \"" << profile_phase_name((profile_phase)i) << "\", \"calls\": " << calls[i]
+            << ", \"samples\": " << sorted.size() << ", \"total_ns\": " << total_ns[i]
+            << ", \"mean_ns\": " << total_ns[i] / (double)sorted.size()
+            << ", \"p50_ns\": " << sorted[sorted.size() / 2]
+            << ", \"p99_ns\": " << sorted[min(sorted.size() - 1, sorted.size() * 99 / 100)] << "}";
+        first = false;
+    }
+    out << "\n  ],\n  \"counters\": {";
+    for (size_t i = 0; i < counters.size(); i++)
+        out << (i == 0 ? "" : ", ") << '"' << profile_counter_name((profile_counter)i) << "\": " << counters[i];
+    out << '}';
+    if (track_allocations)
+    {
+        out << ",\n  \"allocations\": [";
+        first = true;
+        for (size_t i = 0; i < allocations.size(); i++)
+        {
+            if (allocations[i] == 0)
+                continue;
+            out << (first ? "\n" : ",\n") << "    {\"name\": \"" << (i < samples.size() ? profile_phase_name((profile_phase)i) : "other") << "\", \"allocations\": " << allocations[i]
+                << ", \"bytes\": " << allocated_bytes[i] << '}';
+            first = false;
+        }
+        out << "\n  ]";
+    }
+    out << "\n}\n";
+}
+
+scoped_timer::scoped_timer(const profile_phase &_p)
+    : p(_p), previous(profiler::current_phase()), start(chrono::steady_clock::now())
+{
+    profiler::current_phase() = p;
+}
+
+scoped_timer::~scoped_timer()
+{
+    profiler::instance().add_time(p, chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+    profiler::current_phase() = previous;
+}
+
+const char *profile_phase_name(const profile_phase &p)
+{
+    switch (p)
+    {
+    case profile_phase::csv_load:
+        return "csv_load";
+    case profile_phase::split:
+        return "split";
+    case profile_phase::construction:
+        return "construction";
+    case profile_phase::forward:
+        return "forward";
+    case profile_phase::error:
+        return "error";
+    case profile_phase::delta:
+        return "delta";
+    case profile_phase::allreduce:
+        return "allreduce";
+    case profile_phase::gradient_update:
+        return "gradient_update";
+    case profile_phase::gradient_descent:
+        return "gradient_descent";
+    case profile_phase::checkpoint:
+        return "checkpoint";
+    case profile_phase::evaluation:
+        return "evaluation";
+    default:
+        return "";
+    }
+}
+
+const char *profile_counter_name(const profile_counter &c)
+{
+    switch (c)
+    {
+    case profile_counter::rows_loaded:
+        return "rows_loaded";
+    case profile_counter::instances_trained:
+        return "instances_trained";
+    case profile_counter::instances_evaluated:
+        return "instances_evaluated";
+    case profile_counter::iterations:
+        return "iterations";
+    default:
+        return "";
+    }
+}
@@ -0,0 +1,245 @@
+#include <iostream>
+#include <stdexcept>
+#include <fstream>
+#include <vector>
+#include <cmath>
+#include <charconv>
+#include <algorithm>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief Features of a file in the format of x.csv whose columns could contain categorical tokens, such as names or IDs, as well as numbers. A number in column j is feature j. A token in column j is hashed with j into one of the 2^hash_bits features after the columns (The hashing trick), and the feature is 1, or +1 or -1 chosen by another bit of the hash with signed hashing, so the collisions of different tokens cancel out on average instead of adding up. The tokens are never stored, so there is no dictionary of the tokens and no one-hot vector of a column, and the features are stored in the CSR format for the sparse first layer. Empty fields are missing values and give no feature.
+ *
+ */
+class read_hashed_x : public sparse_matrix
+{
+
+public:
+    /**
+    * @brief Construct a new read hashed x::read hashed x object which reads the features from a file and hashes its tokens while parsing.
+    *
+    * @param filename The file name that contains the features data.
+    * @param _hash_bits The tokens are hashed into 2^hash_bits features.
+    * @param _signed_hash If the features of the tokens are +1 or -1 instead of 1.
+    */
+    read_hashed_x(const string &, const uint64_t &, const bool &);
+
+    /**
+    * @brief Member function to read a line of the dataset.
+    *
+    * @param in The line.
+    */
+    void read_values(const string &);
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of columns of the file.
+    *
+    * @return uint64_t Number of columns, which are the first features.
+    */
+    uint64_t get_columns() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of tokens which were hashed.
+    *
+    * @return uint64_t Number of fields which were not numbers.
+    */
+    uint64_t get_tokens() const;
+
+    /**
+     * @brief Error if the number of columns is less than in the first line.
+     *
+     */
+    class column_shortage : public length_error
+    {
+    public:
+        column_shortage() : length_error("Number of columns is less than number of features! All lines should have equal number of columns."){};
+    };
+
+    /**
+     * @brief Error if the number of columns is more than in the first line.
+     *
+     */
+    class column_excess : public length_error
+    {
+    public:
+        column_excess() : length_error("Number of columns is more than number of features! All lines should have equal number of columns."){};
+    };
+
+    /**
+     * @brief Error if there are any problems with the file.
+     *
+     */
+    class invalid_file : public invalid_argument
+    {
+    public:
+        invalid_file() : invalid_argument(""){};
+    };
+
+private:
+    /**
+     * @brief Number of columns of the file.
+     *
+     */
+    uint64_t columns = 0;
+
+    /**
+     * @brief The tokens are hashed into 2^hash_bits features.
+     *
+     */
+    uint64_t hash_bits = 20;
+
+    /**
+     * @brief If the features of the tokens are +1 or -1 instead of 1.
+     *
+     */
+    bool signed_hash = false;
+
+    /**
+     * @brief Number of fields which were not numbers.
+     *
+     */
+    uint64_t tokens = 0;
+
+    /**
+     * @brief The features of the current line before they are sorted and the features of colliding tokens are added (Reused for all the lines).
+     *
+     */
+    vector<pair<uint64_t, double>> row;
+};
+
+/**
+ * @brief Hash of a token of a column (64-bit FNV-1a of the characters, started from the mixed column number and finished by the SplitMix64 finalizer), so the same token in different columns gives unrelated hashes.
+ *
+ * @param column The column of the token (Starting from 1).
+ * @param begin The first character of the token.
+ * @param end The character after the last one.
+ * @return uint64_t The hash.
+ */
+uint64_t hash_token(const uint64_t &, const char *, const char *);
+
+// ==============
+// Implementation
+// ==============
+
+uint64_t hash_token(const uint64_t &column, const char *begin, const char *end)
+{
+    uint64_t h = 0xCBF29CE484222325ULL ^ splitmix64(column);
+    for (const char *p = begin; p < end; p++)
+    {
+        h ^= (unsigned char)*p;
+        h *= 0x100000001B3ULL;
+    }
+    return splitmix64(h);
+}
+
+uint64_t read_hashed_x::get_columns() const
+{
+    return columns;
+}
+
+uint64_t read_hashed_x::get_tokens() const
+{
+    return tokens;
+}
+
+read_hashed_x::read_hashed_x(const string &filename, const uint64_t &_hash_bits, const bool &_signed_hash)
+    : hash_bits(_hash_bits), signed_hash(_signed_hash)
+{
+    PROFILE_SCOPE(csv_load);
+    ifstream input(filename);
+    if (!input.is_open())
+    {
+        cout << "Error opening " << filename << " input file!";
+        throw invalid_file();
+    }
+    // The lines are parsed while reading, so the file is never held in memory.
+    string s;
+    uint64_t line = 0;
+    while (getline(input, s))
+    {
+        line++;
+        if (!s.empty() && s.back() == '\r') // Files with Windows line endings.
+            s.pop_back();
+        if (line == 1)
+            columns = count(s.begin(), s.end(), ',') + 1;
+        try
+        {
+            read_values(s);
+        }
+        catch (const exception &e)
+        {
+            cout << "Error in line " << line << " " << filename << ": " << e.what() << '\n';
+            throw invalid_file();
+        }
+    }
+    if (input.eof())
+        cout << "Reached end of " << filename << "\n";
+    input.close();
+    number_features = columns + (1ULL << hash_bits);
+    PROFILE_COUNT(rows_loaded, rows);
+}
+
+void read_hashed_x::read_values(const string &in)
+{
+    row.clear();
+    const char *p = in.data(), *end = in.data() + in.size();
+    uint64_t column = 0;
+    while (true)
+    {
+        const char *field_end = find(p, end, ',');
+        column++;
+        if (column > columns)
+            throw column_excess();
+
+        // Skipping the spaces around the field.
+        const char *begin = p, *last = field_end;
+        while (begin < last && *begin == ' ')
+            begin++;
+        while (last > begin && *(last - 1) == ' ')
+            last--;
+
+        if (begin < last)
+        {
+            double value = 0;
+            from_chars_result result = from_chars(begin, last, value);
+            if (result.ec == errc() && result.ptr == last && isfinite(value))
+            {
+                if (value != 0)
+                    row.emplace_back(column, value);
+            }
+            else
+            {
+                // A token: the low bits of the hash choose the feature and the highest bit its sign.
+                uint64_t h = hash_token(column, begin, last);
+                row.emplace_back(columns + 1 + (h & ((1ULL << hash_bits) - 1)), signed_hash && (h >> 63) ? -1.0 : 1.0);
+                tokens++;
+            }
+        }
+        if (field_end == end)
+            break;
+        p = field_end + 1;
+    }
+    if (column < columns)
+        throw column_shortage();
+
+    // The features are stored in increasing order, and the features of tokens which were hashed to the same feature are added.
+    sort(row.begin(), row.end());
+    for (uint64_t i = 0; i < row.size();)
+    {
+        uint64_t index = row[i].first;
+        double value = 0;
+        for (; i < row.size() && row[i].first == index; i++)
+            value += row[i].second;
+        if (value != 0)
+        {
+            feature_indices.push_back(index);
+            values.push_back(value);
+        }
+    }
+    row_offsets.push_back(values.size());
+    rows++;
+}
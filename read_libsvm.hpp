@@ -0,0 +1,180 @@
+#include <iostream>
+#include <stdexcept>
+#include <fstream>
+#include <vector>
+#include <charconv>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief A sparse dataset in the libsvm format, where each line is the class of an instance followed by its non-zero features as index:value pairs with increasing indices starting from 1. The features are stored in the CSR format.
+ *
+ */
+class read_libsvm : public sparse_matrix
+{
+
+public:
+    /**
+    * @brief Construct a new read libsvm::read libsvm object which reads the classes and the non-zero features from a file in the libsvm format. The number of features is the largest index in the file.
+    *
+    * @param filename The file name that contains the dataset.
+    */
+    read_libsvm(const string &);
+
+    /**
+    * @brief Member function to read a line of the dataset.
+    *
+    * @param in The line.
+    */
+    void read_values(const string &);
+
+    /**
+    * @brief Member function to obtain (but not modify) the class of each instance.
+    *
+    * @return const vector<uint64_t>& The classes.
+    */
+    const vector<uint64_t> &get_classes() const;
+
+    /**
+    * @brief Member function to replace the labels of the classes by the class numbers 1, 2, ..., number of classes in the order of the labels.
+    *
+    * @return vector<int64_t> The label of each class number (Starting from class 1).
+    */
+    vector<int64_t> encode_classes();
+
+    /**
+     * @brief Error if the class of a line is not an integer number.
+     *
+     */
+    class not_class : public invalid_argument
+    {
+    public:
+        not_class() : invalid_argument("Expected an integer number as the class!"){};
+    };
+
+    /**
+     * @brief Error if a feature is not an index:value pair or the indices are not increasing.
+     *
+     */
+    class not_feature : public invalid_argument
+    {
+    public:
+        not_feature() : invalid_argument("Expected index:value pairs with increasing indices starting from 1!"){};
+    };
+
+    /**
+     * @brief Error if there are any problems with the file.
+     *
+     */
+    class invalid_file : public invalid_argument
+    {
+    public:
+        invalid_file() : invalid_argument(""){};
+    };
+
+private:
+    /**
+     * @brief The class of each instance (Negative labels are stored as their two's complement until the classes are encoded).
+     *
+     */
+    vector<uint64_t> classes;
+};
+
+// ==============
+// Implementation
+// ==============
+
+const vector<uint64_t> &read_libsvm::get_classes() const
+{
+    return classes;
+}
+
+vector<int64_t> read_libsvm::encode_classes()
+{
+    return encode_labels(classes);
+}
+
+read_libsvm::read_libsvm(const string &filename)
+{
+    PROFILE_SCOPE(csv_load);
+    ifstream input(filename);
+    if (!input.is_open())
+    {
+        cout << "Error opening " << filename << " input file!";
+        throw invalid_file();
+    }
+    // The lines are parsed while reading, so the file is never held in memory.
+    string s;
+    uint64_t line = 0;
+    while (getline(input, s))
+    {
+        line++;
+        if (!s.empty() && s.back() == '\r') // Files with Windows line endings.
+            s.pop_back();
+        if (s.empty() || s[0] == '#')
+            continue;
+        try
+        {
+            read_values(s);
+        }
+        catch (const exception &e)
+        {
+            cout << "Error in line " << line << " " << filename << ": " << e.what() << '\n';
+            throw invalid_file();
+        }
+    }
+    if (input.eof())
+        cout << "Reached end of " << filename << "\n";
+    input.close();
+    PROFILE_COUNT(rows_loaded, rows);
+}
+
+void read_libsvm::read_values(const string &in)
+{
+    const char *p = in.data(), *end = in.data() + in.size();
+    auto skip_spaces = [&]()
+    {
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+    };
+
+    // The class, which is signed (-1 and +1 in binary datasets) and could be written with a plus sign.
+    skip_spaces();
+    if (p + 1 < end && *p == '+' && isdigit((unsigned char)p[1]))
+        p++;
+    int64_t label = 0;
+    from_chars_result result = from_chars(p, end, label);
+    if (result.ec != errc() || (result.ptr < end && *result.ptr != ' ' && *result.ptr != '\t'))
+        throw not_class();
+    p = result.ptr;
+
+    // The index:value pairs. Explicit zeros are not stored.
+    uint64_t previous = 0;
+    skip_spaces();
+    while (p < end && *p != '#')
+    {
+        uint64_t index = 0;
+        double value = 0;
+        result = from_chars(p, end, index);
+        if (result.ec != errc() || index <= previous || result.ptr == end || *result.ptr != ':')
+            throw not_feature();
+        result = from_chars(result.ptr + 1, end, value);
+        if (result.ec != errc() || (result.ptr < end && *result.ptr != ' ' && *result.ptr != '\t'))
+            throw not_feature();
+        p = result.ptr;
+        previous = index;
+        if (value != 0)
+        {
+            feature_indices.push_back(index);
+            values.push_back(value);
+        }
+        skip_spaces();
+    }
+    number_features = max(number_features, previous);
+    classes.push_back((uint64_t)label);
+    row_offsets.push_back(values.size());
+    rows++;
+}
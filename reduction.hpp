@@ -0,0 +1,97 @@
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <string>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief The ways the deltas of the instances are summed by several threads.
+ *
+ */
+enum class reduction_mode
+{
+    fast,         // Each thread sums a contiguous part of the instances and the sums of the threads are added, so the result depends on the number of threads.
+    deterministic // The instances are summed in fixed chunks which are added by a fixed pairwise tree, so the result does not depend on the number of threads or their scheduling.
+};
+
+/**
+ * @brief Number of instances of a chunk of the deterministic reduction.
+ *
+ */
+constexpr uint64_t reduction_chunk = 32;
+
+/**
+ * @brief Number of chunks which are added by one pairwise tree in the deterministic reduction. The sums of the trees are added in order.
+ *
+ */
+constexpr uint64_t reduction_group = 64;
+
+/**
+ * @brief Sum of an array by a pairwise tree whose shape only depends on the number of values, so the result is always the same and its rounding error grows with the logarithm of the number of values.
+ *
+ * @param values The values.
+ * @param n Number of values.
+ * @return double The sum.
+ */
+double pairwise_sum(const double *, const uint64_t &);
+
+/**
+ * @brief Adding arrays element by element by a pairwise tree whose shape only depends on the number of arrays: array i + s is added to array i for s = 1, 2, 4, ... The sum is left in the first array.
+ *
+ * @param arrays The arrays, stored one after the other.
+ * @param count Number of arrays.
+ * @param size Number of elements of each array.
+ */
+void pairwise_reduce(double *, const uint64_t &, const uint64_t &);
+
+/**
+ * @brief Converts the name of a reduction mode to its type.
+ *
+ * @param s The name: fast or deterministic.
+ * @return reduction_mode The reduction mode.
+ */
+reduction_mode to_reduction_mode(const string &);
+
+// ==============
+// Implementation
+// ==============
+
+double pairwise_sum(const double *values, const uint64_t &n)
+{
+    if (n <= 8)
+    {
+        double sum = 0;
+        for (uint64_t i = 0; i < n; i++)
+            sum += values[i];
+        return sum;
+    }
+    uint64_t half = n / 2;
+    return pairwise_sum(values, half) + pairwise_sum(values + half, n - half);
+}
+
+void pairwise_reduce(double *arrays, const uint64_t &count, const uint64_t &size)
+{
+    for (uint64_t s = 1; s < count; s *= 2)
+    {
+        for (uint64_t i = 0; i + s < count; i += 2 * s)
+        {
+            double *a = arrays + i * size;
+            const double *b = arrays + (i + s) * size;
+            for (uint64_t j = 0; j < size; j++)
+                a[j] += b[j];
+        }
+    }
+}
+
+reduction_mode to_reduction_mode(const string &s)
+{
+    if (s == "fast")
+        return reduction_mode::fast;
+    if (s == "deterministic")
+        return reduction_mode::deterministic;
+    throw invalid_argument("Expected fast or deterministic!");
+}
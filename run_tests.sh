@@ -0,0 +1,37 @@
+#!/bin/sh
+# Tests which need the programs and a dataset: the programs are built into a temporary directory and run on the wine dataset of the repository. Returns a non-zero status if a test fails.
+#
+# Usage: ./run_tests.sh (The compiler could be chosen with CXX)
+set -e
+repo=$(cd "$(dirname "$0")" && pwd)
+build=$(mktemp -d)
+trap 'rm -rf "$build"' EXIT
+CXX=${CXX:-g++}
+CXXFLAGS="-std=c++17 -O2"
+cp "$repo/x.csv" "$repo/y.csv" "$repo/layers.csv" "$repo/parameters.csv" "$build"
+cd "$build"
+
+# The predictions of the code generated by codegen should be the same as those of the saved model.
+$CXX $CXXFLAGS -o main "$repo/main.cpp" -lpthread
+$CXX $CXXFLAGS -o codegen "$repo/codegen.cpp" -lpthread
+for output in sigmoid softmax; do
+     ./main --seed 11 --output-layer $output --save-model model.csv > /dev/null
+     ./codegen model.csv generated_model.hpp generated_model > /dev/null
+     $CXX $CXXFLAGS -I. -DGENERATED_MODEL='"generated_model.hpp"' -DGENERATED_NAMESPACE=generated_model -o codegen_test "$repo/codegen_test.cpp" -lpthread
+     echo "codegen ($output output layer):"
+     ./codegen_test model.csv x.csv --seed 11
+     ./codegen_test model.csv x.csv
+done
+# The training iterations after the first one and the inference of the test set should not allocate: main is built with the allocation tracker and trained for a few iterations, and it returns a non-zero status if it counts any allocation.
+$CXX $CXXFLAGS -DNN_TRACK_ALLOC -o main_tracked "$repo/main.cpp" -lpthread
+mkdir tracked
+cp x.csv y.csv layers.csv tracked
+printf '5\n2\n80\n0.06\n0.01\n' > tracked/parameters.csv
+cd tracked
+for options in "" "--output-layer softmax" "--batch 16" "--gemm" "--gemm --prefetch 2" "--threads 2" "--threads 2 --reduction deterministic" "--hogwild 2" "--output-layer softmax --sampled-softmax 1"; do
+     echo "allocations ($options):"
+     ../main_tracked --seed 11 $options > output.txt || { grep Error output.txt; exit 1; }
+     echo "none after the first iteration"
+done
+cd ..
+echo "All the tests passed"
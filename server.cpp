@@ -0,0 +1,320 @@
+/**
+ * @file server.cpp
+ * @brief Inference server for a trained model on a Unix domain socket.
+ *
+ * Loads a model saved by main --save-model and answers requests in the binary protocol of inference_protocol.hpp. Each connection is read by its own thread, and the requests of all the connections are collected into batches: a batch is run as soon as it has --max-batch rows or the oldest request has waited --deadline-us microseconds. Throughput, batch size and latency percentiles are printed every --report seconds and when the server is stopped with Ctrl-C.
+ *
+ * Usage: server model.csv [--socket /tmp/nn.sock] [--max-batch 64] [--deadline-us 500] [--report 10]
+ *
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <random>
+#include <fstream>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <csignal>
+#include <poll.h>
+#include "activation.hpp"
+#include "thread_pool.hpp"
+#include "counter_rng.hpp"
+#include "edge.hpp"
+#include "standardization.hpp"
+#include "gemm.hpp"
+#include "model.hpp"
+#include "inference_protocol.hpp"
+
+using namespace std;
+
+/**
+ * @brief A request waiting to be run in a batch. It is owned by the thread of its connection, which waits until done is set.
+ *
+ */
+struct pending_request
+{
+     const double *x;                          // Feature values of the instances.
+     uint64_t rows;                            // Number of instances.
+     double *y;                                // Activations of the output layer of the instances.
+     chrono::steady_clock::time_point arrival; // The time when the request was read.
+     bool done = false;                        // If the batch of the request was run.
+};
+
+/**
+ * @brief Requests of all the connections which are waiting for the next batch.
+ *
+ */
+struct batch_queue
+{
+     mutex queue_mutex;                 // Mutex for all the members.
+     condition_variable request_ready;  // Notified when a request is added or the server stops.
+     condition_variable batch_done;     // Notified when a batch was run.
+     deque<pending_request *> requests; // Requests in order of arrival.
+     uint64_t queued_rows = 0;          // Number of rows of the queued requests.
+     bool stopping = false;             // If the server is stopping.
+};
+
+/**
+ * @brief Throughput and latency of the requests since the last report.
+ *
+ */
+struct server_statistics
+{
+     uint64_t requests = 0;                                                // Number of requests.
+     uint64_t rows = 0;                                                    // Number of instances of the requests.
+     uint64_t batches = 0;                                                 // Number of batches.
+     vector<double> latencies_us;                                          // Time from reading each request to running its batch.
+     chrono::steady_clock::time_point start = chrono::steady_clock::now(); // Start of the window.
+
+     /**
+     * @brief Printing the statistics and starting a new window.
+     *
+     * @param out Output stream.
+     */
+     void report(ostream &out)
+     {
+          double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+          out << "requests: " << requests << " (" << requests / seconds << "/s), rows: " << rows << " (" << rows / seconds << "/s), mean batch: " << (batches > 0 ? rows / (double)batches : 0)
+               << " rows, latency p50: " << percentile(latencies_us, 50) << " us, p99: " << percentile(latencies_us, 99) << " us, p99.9: " << percentile(latencies_us, 99.9) << " us\n";
+          requests = rows = batches = 0;
+          latencies_us.clear();
+          start = chrono::steady_clock::now();
+     }
+};
+
+/**
+ * @brief Set by SIGINT or SIGTERM to stop the server.
+ *
+ */
+volatile sig_atomic_t stop_requested = 0;
+
+/**
+ * @brief Signal handler which stops the server.
+ *
+ */
+void request_stop(int)
+{
+     stop_requested = 1;
+}
+
+/**
+ * @brief Reading the requests of a connection, adding them to the queue and writing the responses.
+ *
+ * @param fd The socket of the connection.
+ * @param m The model.
+ * @param queue The queue of the batches.
+ * @param max_batch Maximum number of rows of a batch.
+ */
+void serve_connection(const int fd, const model &m, batch_queue &queue, const uint64_t max_batch)
+{
+     uint64_t features = m.get_number_nodes().front(), outputs = m.get_number_nodes().back();
+     vector<double> x, y; // Reused by all the requests of the connection.
+     vector<uint32_t> classes;
+     request_header request;
+     while (read_exact(fd, &request, sizeof(request)))
+     {
+          response_header response = {status_ok, request.rows, (uint32_t)outputs};
+          if (request.features != features)
+               response.status = status_wrong_features;
+          else if (request.rows > max_batch)
+               response.status = status_too_many_rows;
+
+          // The size of a rejected request is not trusted, so its features are not read and the connection is closed after the response.
+          if (response.status != status_ok)
+          {
+               response.rows = 0;
+               write_exact(fd, &response, sizeof(response));
+               break;
+          }
+          x.resize((uint64_t)request.rows * request.features);
+          if (!read_exact(fd, x.data(), x.size() * sizeof(double)))
+               break;
+
+          y.resize(request.rows * outputs);
+          pending_request r = {x.data(), request.rows, y.data(), chrono::steady_clock::now()};
+          {
+               unique_lock<mutex> lock(queue.queue_mutex);
+               queue.requests.push_back(&r);
+               queue.queued_rows += r.rows;
+               queue.request_ready.notify_one();
+               queue.batch_done.wait(lock, [&]()
+                                     { return r.done || queue.stopping; });
+               if (!r.done)
+                    break;
+          }
+
+          classes.resize(request.rows);
+          for (uint64_t i = 0; i < request.rows; i++)
+               classes[i] = m.predict(&y[i * outputs]);
+          if (!write_exact(fd, &response, sizeof(response)) || !write_exact(fd, classes.data(), classes.size() * sizeof(uint32_t)) || !write_exact(fd, y.data(), y.size() * sizeof(double)))
+               break;
+     }
+     close(fd);
+}
+
+/**
+ * @brief Collecting the queued requests into batches and running them through the model until the server stops.
+ *
+ * @param m The model.
+ * @param queue The queue of the batches.
+ * @param max_batch Maximum number of rows of a batch.
+ * @param deadline Maximum time the oldest request waits for more requests.
+ * @param report_interval Time between the reports (No periodic reports if zero).
+ */
+void run_batches(const model &m, batch_queue &queue, const uint64_t max_batch, const chrono::microseconds deadline, const chrono::seconds report_interval)
+{
+     uint64_t features = m.get_number_nodes().front(), outputs = m.get_number_nodes().back();
+     vector<pending_request *> batch;
+     vector<double> batch_x(max_batch * features), batch_y(max_batch * outputs), workspace;
+     server_statistics statistics;
+     while (true)
+     {
+          uint64_t rows = 0;
+          {
+               unique_lock<mutex> lock(queue.queue_mutex);
+               queue.request_ready.wait(lock, [&]()
+                                        { return !queue.requests.empty() || queue.stopping; });
+               if (queue.stopping)
+                    break;
+               // Waiting for more requests until the batch is full or the oldest request reaches the deadline.
+               queue.request_ready.wait_until(lock, queue.requests.front()->arrival + deadline, [&]()
+                                              { return queue.queued_rows >= max_batch || queue.stopping; });
+               batch.clear();
+               while (!queue.requests.empty() && rows + queue.requests.front()->rows <= max_batch)
+               {
+                    batch.push_back(queue.requests.front());
+                    rows += batch.back()->rows;
+                    queue.queued_rows -= batch.back()->rows;
+                    queue.requests.pop_front();
+               }
+          }
+
+          // The requests are copied into one matrix, so the weights are read once for the whole batch.
+          uint64_t row = 0;
+          for (pending_request *r : batch)
+          {
+               copy(r->x, r->x + r->rows * features, &batch_x[row * features]);
+               row += r->rows;
+          }
+          m.forward_batch(batch_x.data(), rows, batch_y.data(), workspace);
+
+          chrono::steady_clock::time_point now = chrono::steady_clock::now();
+          row = 0;
+          {
+               lock_guard<mutex> lock(queue.queue_mutex);
+               for (pending_request *r : batch)
+               {
+                    copy(&batch_y[row * outputs], &batch_y[(row + r->rows) * outputs], r->y);
+                    row += r->rows;
+                    statistics.latencies_us.push_back(chrono::duration<double, micro>(now - r->arrival).count());
+                    r->done = true;
+               }
+          }
+          queue.batch_done.notify_all();
+          statistics.requests += batch.size();
+          statistics.rows += rows;
+          statistics.batches++;
+          if (report_interval.count() > 0 && now - statistics.start >= report_interval)
+               statistics.report(cout);
+     }
+     statistics.report(cout);
+}
+
+int main(int argc, char *argv[])
+{
+     try
+     {
+          // Reading the command line options.
+          if (argc < 2)
+          {
+               cout << "Usage: " << argv[0] << " model.csv [--socket /tmp/nn.sock] [--max-batch 64] [--deadline-us 500] [--report 10]\n";
+               return -1;
+          }
+          string socket_path = "/tmp/nn.sock";
+          uint64_t max_batch = 64;
+          uint64_t deadline_us = 500;
+          uint64_t report_seconds = 10;
+          for (int i = 2; i < argc; i++)
+          {
+               string option = argv[i];
+               if (i + 1 >= argc)
+                    option = "";
+               try
+               {
+                    if (option == "--socket")
+                         socket_path = argv[++i];
+                    else if (option == "--max-batch")
+                         max_batch = max<uint64_t>(stoull(argv[++i]), 1);
+                    else if (option == "--deadline-us")
+                         deadline_us = stoull(argv[++i]);
+                    else if (option == "--report")
+                         report_seconds = stoull(argv[++i]);
+                    else
+                         option = "";
+               }
+               catch (const logic_error &e) // The value of the option is not a number or is out of range.
+               {
+                    option = "";
+               }
+               if (option.empty())
+               {
+                    cout << "Usage: " << argv[0] << " model.csv [--socket /tmp/nn.sock] [--max-batch 64] [--deadline-us 500] [--report 10]\n";
+                    return -1;
+               }
+          }
+
+          // Reading the trained model.
+          model m(argv[1]);
+
+          // Listening on the socket.
+          sockaddr_un address;
+          if (!unix_address(socket_path, address))
+          {
+               cout << "The socket path " << socket_path << " is too long!\n";
+               return -1;
+          }
+          int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+          unlink(socket_path.c_str());
+          if (listen_fd < 0 || ::bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listen_fd, 128) != 0)
+          {
+               cout << "Error listening on " << socket_path << "!\n";
+               return -1;
+          }
+          signal(SIGINT, request_stop);
+          signal(SIGTERM, request_stop);
+          cout << "Serving the model" << m << "on " << socket_path << " (max batch " << max_batch << " rows, deadline " << deadline_us << " us)\n";
+
+          batch_queue queue;
+          thread batcher(run_batches, cref(m), ref(queue), max_batch, chrono::microseconds(deadline_us), chrono::seconds(report_seconds));
+
+          // Accepting connections until the server is stopped.
+          pollfd p = {listen_fd, POLLIN, 0};
+          while (!stop_requested)
+          {
+               if (poll(&p, 1, 200) <= 0)
+                    continue;
+               int fd = accept(listen_fd, nullptr, nullptr);
+               if (fd >= 0)
+                    thread(serve_connection, fd, cref(m), ref(queue), max_batch).detach();
+          }
+
+          {
+               lock_guard<mutex> lock(queue.queue_mutex);
+               queue.stopping = true;
+          }
+          queue.request_ready.notify_all();
+          queue.batch_done.notify_all();
+          batcher.join();
+          close(listen_fd);
+          unlink(socket_path.c_str());
+     }
+     catch (const exception &e)
+     {
+          cout << e.what() << '\n';
+          return -1;
+     }
+}
@@ -0,0 +1,123 @@
+#include <iostream>
+#include <vector>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief Sparse features of a dataset in the compressed sparse row (CSR) format: the non-zero features of row r are feature_indices[k] and values[k] for k from row_offsets[r] to row_offsets[r + 1], with increasing indices starting from 1. The memory grows with the number of non-zero values instead of rows × features. The loaders of the sparse formats derive from this class.
+ *
+ */
+class sparse_matrix
+{
+
+public:
+    /**
+    * @brief Member function to obtain (but not modify) the number of instances of the dataset.
+    *
+    * @return uint64_t Number of rows (instances) of the dataset.
+    */
+    uint64_t get_rows() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of features of the dataset.
+    *
+    * @return uint64_t Number of features, which is at least the largest index of a feature.
+    */
+    uint64_t get_cols() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of non-zero values of the dataset.
+    *
+    * @return uint64_t Number of non-zero values.
+    */
+    uint64_t get_nonzeros() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the position of the first non-zero value of each row, followed by the number of non-zero values.
+    *
+    * @return const vector<uint64_t>& The offsets of the rows (Number of rows + 1 values).
+    */
+    const vector<uint64_t> &get_row_offsets() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the index of the feature of each non-zero value.
+    *
+    * @return const vector<uint64_t>& The indices of the features (Starting from 1).
+    */
+    const vector<uint64_t> &get_feature_indices() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the non-zero values.
+    *
+    * @return const vector<double>& The values.
+    */
+    const vector<double> &get_values() const;
+
+protected:
+    /**
+     * @brief The number of rows in the dataset file.
+     *
+     */
+    uint64_t rows = 0;
+
+    /**
+     * @brief The number of features.
+     *
+     */
+    uint64_t number_features = 0;
+
+    /**
+     * @brief The position of the first non-zero value of each row, followed by the number of non-zero values.
+     *
+     */
+    vector<uint64_t> row_offsets = vector<uint64_t>(1, 0);
+
+    /**
+     * @brief The index of the feature of each non-zero value.
+     *
+     */
+    vector<uint64_t> feature_indices;
+
+    /**
+     * @brief The non-zero values.
+     *
+     */
+    vector<double> values;
+};
+
+// ==============
+// Implementation
+// ==============
+
+uint64_t sparse_matrix::get_rows() const
+{
+    return rows;
+}
+
+uint64_t sparse_matrix::get_cols() const
+{
+    return number_features;
+}
+
+uint64_t sparse_matrix::get_nonzeros() const
+{
+    return values.size();
+}
+
+const vector<uint64_t> &sparse_matrix::get_row_offsets() const
+{
+    return row_offsets;
+}
+
+const vector<uint64_t> &sparse_matrix::get_feature_indices() const
+{
+    return feature_indices;
+}
+
+const vector<double> &sparse_matrix::get_values() const
+{
+    return values;
+}
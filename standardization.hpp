@@ -0,0 +1,352 @@
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <algorithm>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief The transforms which could be applied to the features before training.
+ *
+ */
+enum class scaling_type
+{
+    none,
+    standard, // (x - mean) / standard deviation.
+    minmax    // (x - min) / (max - min).
+};
+
+/**
+ * @brief Mean, variance, minimum and maximum of each column of a dataset, which are updated one row at a time (Welford's algorithm), so they could be computed in the same pass that reads the rows. The statistics of different parts of a dataset could be merged.
+ *
+ */
+class column_statistics
+{
+
+public:
+    /**
+    * @brief Construct a new column statistics::column statistics object for a number of columns.
+    *
+    * @param _columns Number of columns.
+    */
+    column_statistics(const uint64_t & = 0);
+
+    /**
+    * @brief Member function to add a row to the statistics.
+    *
+    * @param row The values of the row.
+    */
+    void add(const double *);
+
+    /**
+    * @brief Member function to merge the statistics of another part of the dataset with the same columns.
+    *
+    * @param other The statistics of the other part.
+    */
+    void merge(const column_statistics &);
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of rows.
+    *
+    * @return uint64_t Number of rows.
+    */
+    uint64_t get_count() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of columns.
+    *
+    * @return uint64_t Number of columns.
+    */
+    uint64_t get_columns() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the mean of a column.
+    *
+    * @param j The column starting from 0.
+    * @return double The mean.
+    */
+    double get_mean(const uint64_t &) const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the population variance of a column.
+    *
+    * @param j The column starting from 0.
+    * @return double The variance.
+    */
+    double get_variance(const uint64_t &) const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the minimum of a column.
+    *
+    * @param j The column starting from 0.
+    * @return double The minimum.
+    */
+    double get_min(const uint64_t &) const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the maximum of a column.
+    *
+    * @param j The column starting from 0.
+    * @return double The maximum.
+    */
+    double get_max(const uint64_t &) const;
+
+private:
+    /**
+     * @brief Number of rows.
+     *
+     */
+    uint64_t count = 0;
+
+    /**
+     * @brief Mean of each column.
+     *
+     */
+    vector<double> mean;
+
+    /**
+     * @brief Sum of the squared differences from the mean of each column.
+     *
+     */
+    vector<double> m2;
+
+    /**
+     * @brief Minimum of each column.
+     *
+     */
+    vector<double> minimum;
+
+    /**
+     * @brief Maximum of each column.
+     *
+     */
+    vector<double> maximum;
+};
+
+/**
+ * @brief Affine transform of the features, x' = (x - offset) * scale for each column.
+ *
+ */
+class feature_transform
+{
+
+public:
+    /**
+    * @brief Construct a new feature transform::feature transform object which does not change the features.
+    *
+    */
+    feature_transform() = default;
+
+    /**
+    * @brief Construct a new feature transform::feature transform object from the statistics of the features.
+    *
+    * @param statistics Statistics of the columns of the features.
+    * @param type The kind of transform. A column with no spread is only shifted.
+    */
+    feature_transform(const column_statistics &, const scaling_type &);
+
+    /**
+    * @brief Construct a new feature transform::feature transform object from its parameters.
+    *
+    * @param _offset Offset of each column.
+    * @param _scale Scale of each column.
+    */
+    feature_transform(const vector<double> &, const vector<double> &);
+
+    /**
+    * @brief Member function to check if the transform changes the features.
+    *
+    * @return true If there is no transform.
+    * @return false If the features are transformed.
+    */
+    bool empty() const;
+
+    /**
+    * @brief Member function to transform the features of a row in place.
+    *
+    * @param x Feature values of the row (Without the bias unit).
+    */
+    void apply(double *) const;
+
+    /**
+    * @brief Member function to transform the rows of a dataset in place. Large datasets are divided between the threads of the thread pool.
+    *
+    * @param values The rows of the dataset.
+    * @param first_column Column of the first feature (1 if each row starts with the bias unit).
+    */
+    void apply(vector<vector<double>> &, const uint64_t &) const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the offsets.
+    *
+    * @return const vector<double>& Offset of each column.
+    */
+    const vector<double> &get_offset() const;
+
+    /**
+    * @brief Member function to obtain (but not modify) the scales.
+    *
+    * @return const vector<double>& Scale of each column.
+    */
+    const vector<double> &get_scale() const;
+
+private:
+    /**
+     * @brief Offset of each column (Empty if there is no transform).
+     *
+     */
+    vector<double> offset;
+
+    /**
+     * @brief Scale of each column (Empty if there is no transform).
+     *
+     */
+    vector<double> scale;
+};
+
+/**
+ * @brief Converts the name of a transform to its type.
+ *
+ * @param s The name: none, standard or minmax.
+ * @return scaling_type The type of the transform.
+ */
+scaling_type to_scaling_type(const string &);
+
+// ==============
+// Implementation
+// ==============
+
+column_statistics::column_statistics(const uint64_t &_columns)
+    : mean(_columns, 0), m2(_columns, 0), minimum(_columns, numeric_limits<double>::infinity()), maximum(_columns, -numeric_limits<double>::infinity())
+{
+}
+
+void column_statistics::add(const double *row)
+{
+    count++;
+    for (uint64_t j = 0; j < mean.size(); j++)
+    {
+        double difference = row[j] - mean[j];
+        mean[j] += difference / (double)count;
+        m2[j] += difference * (row[j] - mean[j]);
+        minimum[j] = min(minimum[j], row[j]);
+        maximum[j] = max(maximum[j], row[j]);
+    }
+}
+
+void column_statistics::merge(const column_statistics &other)
+{
+    if (other.count == 0)
+        return;
+    uint64_t total = count + other.count;
+    for (uint64_t j = 0; j < mean.size(); j++)
+    {
+        double difference = other.mean[j] - mean[j];
+        mean[j] += difference * (double)other.count / (double)total;
+        m2[j] += other.m2[j] + difference * difference * (double)count * (double)other.count / (double)total;
+        minimum[j] = min(minimum[j], other.minimum[j]);
+        maximum[j] = max(maximum[j], other.maximum[j]);
+    }
+    count = total;
+}
+
+uint64_t column_statistics::get_count() const
+{
+    return count;
+}
+
+uint64_t column_statistics::get_columns() const
+{
+    return mean.size();
+}
+
+double column_statistics::get_mean(const uint64_t &j) const
+{
+    return mean[j];
+}
+
+double column_statistics::get_variance(const uint64_t &j) const
+{
+    return count > 0 ? m2[j] / (double)count : 0;
+}
+
+double column_statistics::get_min(const uint64_t &j) const
+{
+    return minimum[j];
+}
+
+double column_statistics::get_max(const uint64_t &j) const
+{
+    return maximum[j];
+}
+
+feature_transform::feature_transform(const column_statistics &statistics, const scaling_type &type)
+{
+    if (type == scaling_type::none || statistics.get_count() == 0)
+        return;
+    offset.resize(statistics.get_columns());
+    scale.resize(statistics.get_columns());
+    for (uint64_t j = 0; j < offset.size(); j++)
+    {
+        double spread = type == scaling_type::standard ? sqrt(statistics.get_variance(j)) : statistics.get_max(j) - statistics.get_min(j);
+        offset[j] = type == scaling_type::standard ? statistics.get_mean(j) : statistics.get_min(j);
+        scale[j] = spread > 0 ? 1 / spread : 1;
+    }
+}
+
+feature_transform::feature_transform(const vector<double> &_offset, const vector<double> &_scale)
+    : offset(_offset), scale(_scale)
+{
+}
+
+bool feature_transform::empty() const
+{
+    return offset.empty();
+}
+
+void feature_transform::apply(double *x) const
+{
+    // A simple loop over contiguous arrays, which the compiler vectorizes.
+    for (uint64_t j = 0; j < offset.size(); j++)
+        x[j] = (x[j] - offset[j]) * scale[j];
+}
+
+void feature_transform::apply(vector<vector<double>> &values, const uint64_t &first_column) const
+{
+    if (empty())
+        return;
+    // Ranges of about 2^16 values.
+    thread_pool::instance().parallel_for(0, values.size(), max<uint64_t>((1 << 16) / max<uint64_t>(offset.size(), 1), 1), [&](const uint64_t &begin, const uint64_t &end)
+                                         {
+                                             for (uint64_t i = begin; i < end; i++)
+                                                 apply(&values[i][first_column]);
+                                         });
+}
+
+const vector<double> &feature_transform::get_offset() const
+{
+    return offset;
+}
+
+const vector<double> &feature_transform::get_scale() const
+{
+    return scale;
+}
+
+scaling_type to_scaling_type(const string &s)
+{
+    if (s == "none")
+        return scaling_type::none;
+    if (s == "standard")
+        return scaling_type::standard;
+    if (s == "minmax")
+        return scaling_type::minmax;
+    throw invalid_argument("Expected none, standard or minmax!");
+}
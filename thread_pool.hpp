@@ -0,0 +1,518 @@
+#include <iostream>
+#include <vector>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <algorithm>
+#include <new>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief Statistics of the thread pool since it was started or reset.
+ *
+ */
+struct thread_pool_statistics
+{
+    /**
+     * @brief Number of ranges which were run.
+     *
+     */
+    uint64_t tasks = 0;
+
+    /**
+     * @brief Number of ranges which were taken from the queue of another thread.
+     *
+     */
+    uint64_t steals = 0;
+
+    /**
+     * @brief Time which the threads spent without a range to run in nanoseconds: the workers while they sleep or look for work, and the callers of parallel_for() while they wait for ranges which are run by other threads.
+     *
+     */
+    uint64_t idle_ns = 0;
+
+    /**
+     * @brief The largest number of ranges which were waiting in one queue.
+     *
+     */
+    uint64_t max_queue_depth = 0;
+};
+
+/**
+ * @brief Persistent work-stealing thread pool shared by the whole program. The threads are started once, and every parallel phase (parsing, standardization, initialization of the weights, the logical threads of gradient_accumulator and hogwild_train(), the products of gemm() and the evaluation) divides its range between them with parallel_for(), instead of starting its own threads. The cross-validation folds of main are not tasks: they run one after the other, since each fold prints its results, forks its worker processes and writes its checkpoints in order, and the phases inside a fold use the pool. A range is split in half until it is not larger than the grain: one half is pushed to the queue of the thread and the other half is split further, so a thread which has no work takes the oldest (and largest) half of another queue while the owner continues with the newest one. A caller of parallel_for() runs ranges, of its own loop or of any other, until all the ranges of its loop have finished, so a parallel_for() inside a task of another parallel_for() (such as the products of the batches of the evaluation) uses the same threads instead of starting more threads than CPUs. Nothing is allocated by parallel_for(): the loop lives on the stack of the caller and the queues have a fixed capacity (a range which does not fit is run by the thread which split it).
+ *
+ */
+class thread_pool
+{
+
+public:
+    /**
+    * @brief Static member function to obtain the thread pool shared by the whole program, which is started with one thread per CPU on its first use.
+    *
+    * @return thread_pool& The thread pool.
+    */
+    static thread_pool &instance();
+
+    /**
+    * @brief Destroy the thread pool::thread pool object and join the threads.
+    *
+    */
+    ~thread_pool();
+
+    /**
+    * @brief Member function to change the number of threads. It must not be called while a parallel_for() is running.
+    *
+    * @param number_threads Number of threads, including the thread which calls parallel_for() (1 runs every loop in the caller).
+    */
+    void resize(const uint64_t &);
+
+    /**
+    * @brief Member function to start the workers again in a child process after fork(), which only has the thread which called fork(). The workers of the parent are left to the parent without joining them, and the locks are made again, since a worker could have held one while the process was forked. It must be called by the child before its first parallel_for().
+    *
+    */
+    void restart_after_fork();
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of threads, including the thread which calls parallel_for().
+    *
+    * @return uint64_t Number of threads.
+    */
+    uint64_t get_threads() const;
+
+    /**
+    * @brief Member function to call a function on ranges of [begin, end) in parallel and return when all of them have finished. Each range has at most grain elements, so the grain should be large enough for a range to take a few microseconds.
+    *
+    * @tparam Function A function of (uint64_t begin, uint64_t end).
+    * @param begin The first element.
+    * @param end The element after the last one.
+    * @param grain Largest number of elements of a range (At least 1).
+    * @param f The function.
+    */
+    template <typename Function>
+    void parallel_for(const uint64_t &, const uint64_t &, const uint64_t &, const Function &);
+
+    /**
+    * @brief Member function to obtain (but not modify) the statistics of all the threads.
+    *
+    * @return thread_pool_statistics The statistics.
+    */
+    thread_pool_statistics get_statistics() const;
+
+    /**
+    * @brief Member function to set the statistics to zero.
+    *
+    */
+    void reset_statistics();
+
+    /**
+    * @brief Member function to print the threads, ranges, steals, idle time and largest queue depth.
+    *
+    * @param out Output stream.
+    */
+    void print_statistics(ostream &) const;
+
+private:
+    /**
+     * @brief A loop of parallel_for(), which lives on the stack of its caller.
+     *
+     */
+    struct loop
+    {
+        /**
+         * @brief Function which calls the function of the loop on a range.
+         *
+         */
+        void (*run)(const void *, uint64_t, uint64_t);
+
+        /**
+         * @brief The function of the loop.
+         *
+         */
+        const void *function;
+
+        /**
+         * @brief Largest number of elements of a range.
+         *
+         */
+        uint64_t grain;
+
+        /**
+         * @brief Number of elements which have not been run yet.
+         *
+         */
+        atomic<uint64_t> remaining;
+    };
+
+    /**
+     * @brief A range of a loop which is waiting in a queue.
+     *
+     */
+    struct task
+    {
+        loop *owner;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    /**
+     * @brief Capacity of each queue. A range is split at most log2((end - begin) / grain) times before it is run, so a queue rarely holds more than a few dozen ranges.
+     *
+     */
+    static constexpr uint64_t queue_capacity = 256;
+
+    /**
+     * @brief Circular queue of a thread with its statistics. The owner pushes and pops the newest range and the other threads steal the oldest one, under a mutex which is rarely contended since the ranges are not small. Each queue has its own cache lines, so the threads do not share lines when they update their statistics.
+     *
+     */
+    struct alignas(64) task_queue
+    {
+        mutex lock;
+        array<task, queue_capacity> tasks;
+        uint64_t head = 0; // Position of the oldest range.
+        uint64_t size = 0;
+        atomic<uint64_t> executed{0};
+        atomic<uint64_t> steals{0};
+        atomic<uint64_t> idle_ns{0};
+        atomic<uint64_t> max_depth{0};
+    };
+
+    /**
+    * @brief Construct a new thread pool::thread pool object with one thread per CPU.
+    *
+    */
+    thread_pool();
+
+    /**
+    * @brief Member function to start the workers, which are all the threads except the callers of parallel_for().
+    *
+    * @param number_workers Number of workers.
+    */
+    void start(const uint64_t &);
+
+    /**
+    * @brief Member function to stop and join the workers.
+    *
+    */
+    void stop();
+
+    /**
+    * @brief Loop of a worker, which runs ranges until the pool is stopped and sleeps when there is nothing to run.
+    *
+    * @param index Number of the worker, which is the number of its queue.
+    */
+    void work(const uint64_t &);
+
+    /**
+    * @brief Member function to run a range of a loop: the range is halved until it is not larger than the grain, and the second halves are pushed to the queue of the calling thread.
+    *
+    * @param l The loop.
+    * @param begin The first element.
+    * @param end The element after the last one.
+    */
+    void run_range(loop &, uint64_t, uint64_t);
+
+    /**
+    * @brief Member function to run one waiting range: the newest range of the queue of the calling thread, or else the oldest range of another queue.
+    *
+    * @return bool If a range was run.
+    */
+    bool run_one();
+
+    /**
+    * @brief Member function to push a range to the queue of the calling thread and wake a sleeping worker.
+    *
+    * @param t The range.
+    * @return bool If it was pushed (False if the queue is full).
+    */
+    bool push(const task &);
+
+    /**
+    * @brief Static member function to obtain the queue of the calling thread: its own queue for a worker and the shared last queue for the other threads.
+    *
+    * @return uint64_t& Number of the queue (-1 for the threads which are not workers).
+    */
+    static uint64_t &thread_queue();
+
+    /**
+     * @brief The queue of each worker, followed by the queue of the other threads.
+     *
+     */
+    vector<unique_ptr<task_queue>> queues;
+
+    /**
+     * @brief The workers.
+     *
+     */
+    vector<thread> workers;
+
+    /**
+     * @brief Number of ranges in all the queues.
+     *
+     */
+    atomic<uint64_t> pending{0};
+
+    /**
+     * @brief Number of workers which are sleeping.
+     *
+     */
+    atomic<uint64_t> sleeping{0};
+
+    /**
+     * @brief If the workers should finish.
+     *
+     */
+    bool stopping = false;
+
+    /**
+     * @brief Mutex for sleeping and waking the workers.
+     *
+     */
+    mutex sleep_lock;
+
+    /**
+     * @brief Condition variable on which the workers sleep.
+     *
+     */
+    condition_variable wake;
+};
+
+// ==============
+// Implementation
+// ==============
+
+thread_pool &thread_pool::instance()
+{
+    static thread_pool p;
+    return p;
+}
+
+thread_pool::thread_pool()
+{
+    start(max<uint64_t>(thread::hardware_concurrency(), 1) - 1);
+}
+
+thread_pool::~thread_pool()
+{
+    stop();
+}
+
+void thread_pool::resize(const uint64_t &number_threads)
+{
+    if (max<uint64_t>(number_threads, 1) == get_threads())
+        return;
+    stop();
+    start(max<uint64_t>(number_threads, 1) - 1);
+}
+
+void thread_pool::restart_after_fork()
+{
+    uint64_t number_workers = workers.size();
+    // The threads and queues of the parent are leaked on purpose: destroying a thread which was not joined would terminate the process, and the queues could be locked.
+    new (&workers) vector<thread>();
+    for (unique_ptr<task_queue> &q : queues)
+        q.release();
+    new (&sleep_lock) mutex();
+    new (&wake) condition_variable();
+    pending = 0;
+    sleeping = 0;
+    start(number_workers);
+}
+
+uint64_t thread_pool::get_threads() const
+{
+    return workers.size() + 1;
+}
+
+template <typename Function>
+void thread_pool::parallel_for(const uint64_t &begin, const uint64_t &end, const uint64_t &grain, const Function &f)
+{
+    if (begin >= end)
+        return;
+    if (workers.empty() || end - begin <= max<uint64_t>(grain, 1))
+    {
+        f(begin, end);
+        return;
+    }
+    loop l;
+    l.run = [](const void *function, uint64_t range_begin, uint64_t range_end)
+    { (*(const Function *)function)(range_begin, range_end); };
+    l.function = &f;
+    l.grain = max<uint64_t>(grain, 1);
+    l.remaining.store(end - begin, memory_order_relaxed);
+    run_range(l, begin, end);
+
+    // Helping with other ranges until the ranges of this loop which were taken by other threads have finished.
+    task_queue &own = *queues[min<uint64_t>(thread_queue(), workers.size())];
+    while (l.remaining.load(memory_order_acquire) != 0)
+    {
+        if (run_one())
+            continue;
+        chrono::steady_clock::time_point idle_start = chrono::steady_clock::now();
+        while (l.remaining.load(memory_order_acquire) != 0 && pending.load() == 0)
+            this_thread::yield();
+        own.idle_ns += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - idle_start).count();
+    }
+}
+
+thread_pool_statistics thread_pool::get_statistics() const
+{
+    thread_pool_statistics s;
+    for (const unique_ptr<task_queue> &q : queues)
+    {
+        s.tasks += q->executed;
+        s.steals += q->steals;
+        s.idle_ns += q->idle_ns;
+        s.max_queue_depth = max<uint64_t>(s.max_queue_depth, q->max_depth);
+    }
+    return s;
+}
+
+void thread_pool::reset_statistics()
+{
+    for (unique_ptr<task_queue> &q : queues)
+    {
+        q->executed = 0;
+        q->steals = 0;
+        q->idle_ns = 0;
+        q->max_depth = 0;
+    }
+}
+
+void thread_pool::print_statistics(ostream &out) const
+{
+    thread_pool_statistics s = get_statistics();
+    out << "Thread pool: " << get_threads() << " threads, " << s.tasks << " ranges, " << s.steals << " steals (" << (s.tasks > 0 ? 100.0 * s.steals / s.tasks : 0) << "%), idle " << s.idle_ns / 1e9 << " s summed over the threads, largest queue " << s.max_queue_depth << '\n';
+}
+
+void thread_pool::start(const uint64_t &number_workers)
+{
+    stopping = false;
+    queues.clear();
+    for (uint64_t i = 0; i <= number_workers; i++)
+        queues.emplace_back(new task_queue);
+    for (uint64_t i = 0; i < number_workers; i++)
+        workers.emplace_back(&thread_pool::work, this, i);
+}
+
+void thread_pool::stop()
+{
+    {
+        lock_guard<mutex> guard(sleep_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread &i : workers)
+        i.join();
+    workers.clear();
+}
+
+void thread_pool::work(const uint64_t &index)
+{
+    thread_queue() = index;
+    task_queue &own = *queues[index];
+    while (true)
+    {
+        if (run_one())
+            continue;
+        chrono::steady_clock::time_point idle_start = chrono::steady_clock::now();
+        // Looking for work a few times before sleeping, since the ranges of a loop are often pushed in quick succession.
+        for (uint64_t attempt = 0; attempt < 64 && pending.load() == 0; attempt++)
+            this_thread::yield();
+        if (pending.load() == 0)
+        {
+            unique_lock<mutex> guard(sleep_lock);
+            sleeping++;
+            wake.wait(guard, [&]()
+                      { return stopping || pending.load() > 0; });
+            sleeping--;
+            if (stopping)
+                return;
+        }
+        own.idle_ns += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - idle_start).count();
+    }
+}
+
+void thread_pool::run_range(loop &l, uint64_t begin, uint64_t end)
+{
+    while (end - begin > l.grain)
+    {
+        uint64_t middle = begin + (end - begin) / 2;
+        if (!push({&l, middle, end}))
+            break;
+        end = middle;
+    }
+    l.run(l.function, begin, end);
+    queues[min<uint64_t>(thread_queue(), workers.size())]->executed++;
+    // The last decrement releases the caller, so the loop must not be used after it.
+    l.remaining.fetch_sub(end - begin, memory_order_release);
+}
+
+bool thread_pool::run_one()
+{
+    uint64_t own = min<uint64_t>(thread_queue(), workers.size());
+    task t;
+    bool found = false;
+    {
+        task_queue &q = *queues[own];
+        lock_guard<mutex> guard(q.lock);
+        if (q.size > 0)
+        {
+            q.size--;
+            t = q.tasks[(q.head + q.size) % queue_capacity];
+            found = true;
+        }
+    }
+    for (uint64_t i = 1; !found && i < queues.size(); i++)
+    {
+        task_queue &q = *queues[(own + i) % queues.size()];
+        lock_guard<mutex> guard(q.lock);
+        if (q.size > 0)
+        {
+            t = q.tasks[q.head];
+            q.head = (q.head + 1) % queue_capacity;
+            q.size--;
+            found = true;
+            queues[own]->steals++;
+        }
+    }
+    if (!found)
+        return false;
+    pending--;
+    run_range(*t.owner, t.begin, t.end);
+    return true;
+}
+
+bool thread_pool::push(const task &t)
+{
+    task_queue &q = *queues[min<uint64_t>(thread_queue(), workers.size())];
+    {
+        lock_guard<mutex> guard(q.lock);
+        if (q.size == queue_capacity)
+            return false;
+        q.tasks[(q.head + q.size) % queue_capacity] = t;
+        q.size++;
+        if (q.size > q.max_depth)
+            q.max_depth = q.size;
+    }
+    pending++;
+    if (sleeping.load() > 0)
+    {
+        lock_guard<mutex> guard(sleep_lock);
+        wake.notify_one();
+    }
+    return true;
+}
+
+uint64_t &thread_pool::thread_queue()
+{
+    static thread_local uint64_t index = -1;
+    return index;
+}
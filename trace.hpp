@@ -0,0 +1,280 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <string>
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief An event of the timeline with its start time and duration.
+ *
+ */
+struct trace_event
+{
+    const char *name;     // Name of the event.
+    const char *arg_name; // Name of the argument of the event (nullptr if the event has no argument).
+    int64_t arg;          // Value of the argument, such as the layer, iteration or fold number.
+    uint64_t start_ns;    // Start time in nanoseconds since the tracer was enabled.
+    uint64_t duration_ns; // Duration in nanoseconds.
+};
+
+/**
+ * @brief The events recorded by one thread. Only its own thread appends to it, so recording needs no lock.
+ *
+ */
+struct trace_buffer
+{
+    uint64_t thread_id = 0;     // Lane of the thread in the timeline.
+    string thread_name;         // Name of the lane.
+    vector<trace_event> events; // The recorded events.
+    uint64_t dropped = 0;       // Number of events which were not recorded because the buffer was full.
+};
+
+/**
+ * @brief Tracer which records the begin and end of events for each thread and writes them in the Chrome trace event format, which could be viewed in Perfetto or chrome://tracing.
+ *
+ */
+class tracer
+{
+
+public:
+    /**
+    * @brief Static member function to obtain the tracer shared by the whole program.
+    *
+    * @return tracer& The tracer.
+    */
+    static tracer &instance();
+
+    /**
+    * @brief Member function to start recording events.
+    *
+    * @param _max_events Maximum number of events recorded by each thread.
+    */
+    void enable(const uint64_t & = 1 << 22);
+
+    /**
+    * @brief Member function to check if events are recorded.
+    *
+    * @return true If the tracer is enabled.
+    * @return false If the tracer is disabled.
+    */
+    bool enabled() const;
+
+    /**
+    * @brief Member function to obtain the time since the tracer was enabled.
+    *
+    * @return uint64_t Time in nanoseconds.
+    */
+    uint64_t now() const;
+
+    /**
+    * @brief Member function to record an event in the buffer of the calling thread.
+    *
+    * @param e The event.
+    */
+    void record(const trace_event &);
+
+    /**
+    * @brief Member function to name the lane of the calling thread, such as "worker 2".
+    *
+    * @param name Name of the thread.
+    */
+    void set_thread_name(const string &);
+
+    /**
+    * @brief Member function to write all the recorded events to a file in the Chrome trace event format. It should be called after the other threads have finished.
+    *
+    * @param filename The file name.
+    */
+    void write(const string &);
+
+private:
+    /**
+    * @brief Member function to obtain the buffer of the calling thread. The buffer is created and registered the first time a thread records an event.
+    *
+    * @return trace_buffer& The buffer.
+    */
+    trace_buffer &thread_buffer();
+
+    /**
+     * @brief If events are recorded.
+     *
+     */
+    atomic<bool> is_enabled{false};
+
+    /**
+     * @brief Maximum number of events recorded by each thread.
+     *
+     */
+    uint64_t max_events = 0;
+
+    /**
+     * @brief The time when the tracer was enabled.
+     *
+     */
+    chrono::steady_clock::time_point origin;
+
+    /**
+     * @brief Mutex for registering the buffers of new threads.
+     *
+     */
+    mutex buffers_mutex;
+
+    /**
+     * @brief Buffers of all the threads which recorded events. They are kept after the threads finish.
+     *
+     */
+    vector<unique_ptr<trace_buffer>> buffers;
+};
+
+/**
+ * @brief Event which starts when the object is constructed and ends when it is destroyed. Nothing is recorded if the tracer is disabled.
+ *
+ */
+class scoped_trace
+{
+
+public:
+    /**
+    * @brief Construct a new scoped trace::scoped trace object and start the event.
+    *
+    * @param name Name of the event.
+    * @param arg_name Name of the argument of the event (nullptr if the event has no argument).
+    * @param arg Value of the argument.
+    */
+    scoped_trace(const char *, const char * = nullptr, const int64_t & = 0);
+
+    /**
+    * @brief Destroy the scoped trace::scoped trace object and record the event.
+    *
+    */
+    ~scoped_trace();
+
+private:
+    /**
+     * @brief The event.
+     *
+     */
+    trace_event e;
+
+    /**
+     * @brief If the tracer was enabled when the event started.
+     *
+     */
+    bool active = false;
+};
+
+// ==============
+// Implementation
+// ==============
+
+tracer &tracer::instance()
+{
+    static tracer t;
+    return t;
+}
+
+void tracer::enable(const uint64_t &_max_events)
+{
+    max_events = _max_events;
+    origin = chrono::steady_clock::now();
+    is_enabled.store(true, memory_order_release);
+}
+
+bool tracer::enabled() const
+{
+    return is_enabled.load(memory_order_relaxed);
+}
+
+uint64_t tracer::now() const
+{
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - origin).count();
+}
+
+trace_buffer &tracer::thread_buffer()
+{
+    thread_local trace_buffer *buffer = nullptr;
+    if (buffer == nullptr)
+    {
+        lock_guard<mutex> lock(buffers_mutex);
+        buffers.push_back(make_unique<trace_buffer>());
+        buffer = buffers.back().get();
+        buffer->thread_id = buffers.size();
+        buffer->thread_name = buffer->thread_id == 1 ? "main" : "thread " + to_string(buffer->thread_id);
+    }
+    return *buffer;
+}
+
+void tracer::record(const trace_event &e)
+{
+    trace_buffer &buffer = thread_buffer();
+    if (buffer.events.size() < max_events)
+        buffer.events.push_back(e);
+    else
+        buffer.dropped++;
+}
+
+void tracer::set_thread_name(const string &name)
+{
+    thread_buffer().thread_name = name;
+}
+
+void tracer::write(const string &filename)
+{
+    ofstream output(filename);
+    if (!output.is_open())
+    {
+        cout << "Error opening " << filename << " output file!";
+        return;
+    }
+    lock_guard<mutex> lock(buffers_mutex);
+    output << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+    bool first = true;
+    uint64_t dropped = 0;
+    for (const unique_ptr<trace_buffer> &b : buffers)
+    {
+        // Metadata event naming the lane of the thread.
+        output << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << b->thread_id << ", \"args\": {\"name\": \"" << b->thread_name << "\"}}";
+        first = false;
+        for (const trace_event &e : b->events)
+        {
+            output << ",\n{\"name\": \"" << e.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << b->thread_id
+                   << ", \"ts\": " << e.start_ns / 1000 << '.' << e.start_ns % 1000 / 100 << e.start_ns % 100 / 10 << e.start_ns % 10
+                   << ", \"dur\": " << e.duration_ns / 1000 << '.' << e.duration_ns % 1000 / 100 << e.duration_ns % 100 / 10 << e.duration_ns % 10;
+            if (e.arg_name != nullptr)
+                output << ", \"args\": {\"" << e.arg_name << "\": " << e.arg << '}';
+            output << '}';
+        }
+        dropped += b->dropped;
+    }
+    output << "\n]}\n";
+    output.close();
+    if (dropped > 0)
+        cout << "\n"
+             << dropped << " trace events were dropped because the buffers were full.\n";
+}
+
+scoped_trace::scoped_trace(const char *name, const char *arg_name, const int64_t &arg)
+{
+    if (tracer::instance().enabled())
+    {
+        active = true;
+        e = {name, arg_name, arg, tracer::instance().now(), 0};
+    }
+}
+
+scoped_trace::~scoped_trace()
+{
+    if (active)
+    {
+        e.duration_ns = tracer::instance().now() - e.start_ns;
+        tracer::instance().record(e);
+    }
+}
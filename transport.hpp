@@ -0,0 +1,298 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// =========
+// Interface
+// =========
+
+/**
+ * @brief Interface for combining values between the worker processes of data-parallel training. Each process has a rank from 0 to size - 1. The shared memory transport is used for the processes of one host, and another transport (such as TCP) could implement the same interface.
+ *
+ */
+class transport
+{
+
+public:
+    /**
+    * @brief Destroy the transport::transport object.
+    *
+    */
+    virtual ~transport() = default;
+
+    /**
+    * @brief Member function to obtain (but not modify) the rank of the calling process.
+    *
+    * @return uint64_t The rank.
+    */
+    virtual uint64_t get_rank() const = 0;
+
+    /**
+    * @brief Member function to obtain (but not modify) the number of processes.
+    *
+    * @return uint64_t Number of processes.
+    */
+    virtual uint64_t get_size() const = 0;
+
+    /**
+    * @brief Member function to replace the values of every process by their sum over all the processes. It should be called by all the processes with the same number of values.
+    *
+    * @param values The values.
+    * @param count Number of values.
+    */
+    virtual void allreduce(double *, const uint64_t &) = 0;
+
+    /**
+    * @brief Member function to wait until all the processes have called it.
+    *
+    */
+    virtual void barrier() = 0;
+};
+
+/**
+ * @brief Transport for the processes of one host through a POSIX shared memory segment. The sum is computed with a ring allreduce: in size - 1 steps each process adds a chunk of its left neighbour to its own (reduce-scatter), and in size - 1 more steps the summed chunks are copied around the ring (allgather). Since every process receives the same summed chunks, the results are identical in all the processes.
+ *
+ */
+class shared_memory_transport : public transport
+{
+
+public:
+    /**
+    * @brief Construct a new shared memory transport::shared memory transport object. Rank 0 creates the segment and the other ranks wait until it exists, so the processes could be started in any order. The constructor returns when all the processes have joined.
+    *
+    * @param _name Name of the shared memory segment, such as "/nn_allreduce".
+    * @param _rank Rank of the calling process.
+    * @param _size Number of processes.
+    * @param _count Maximum number of values of allreduce().
+    */
+    shared_memory_transport(const string &, const uint64_t &, const uint64_t &, const uint64_t &);
+
+    /**
+    * @brief Destroy the shared memory transport::shared memory transport object. Rank 0 removes the name of the segment.
+    *
+    */
+    ~shared_memory_transport();
+
+    shared_memory_transport(const shared_memory_transport &) = delete;
+    shared_memory_transport &operator=(const shared_memory_transport &) = delete;
+
+    uint64_t get_rank() const override;
+    uint64_t get_size() const override;
+    void allreduce(double *, const uint64_t &) override;
+    void barrier() override;
+
+    /**
+     * @brief Error if the shared memory segment could not be created or opened.
+     *
+     */
+    class shared_memory_error : public invalid_argument
+    {
+    public:
+        shared_memory_error(const string &name) : invalid_argument("Could not open the shared memory segment " + name + "!"){};
+    };
+
+    /**
+     * @brief Error if allreduce() is called with more values than the segment was created for.
+     *
+     */
+    class too_many_values : public length_error
+    {
+    public:
+        too_many_values() : length_error("More values than the size of the shared memory segment!"){};
+    };
+
+private:
+    /**
+     * @brief State of the barrier at the start of the segment.
+     *
+     */
+    struct segment_header
+    {
+        atomic<uint64_t> arrived;    // Number of processes waiting in the barrier.
+        atomic<uint64_t> generation; // Number of times the barrier was passed.
+    };
+
+    /**
+     * @brief Member function to obtain the slot of a process in the segment, which its left neighbour reads.
+     *
+     * @param r Rank of the process.
+     * @return double* The slot.
+     */
+    double *slot(const uint64_t &);
+
+    /**
+     * @brief Name of the shared memory segment.
+     *
+     */
+    string name;
+
+    /**
+     * @brief Rank of the calling process.
+     *
+     */
+    uint64_t rank = 0;
+
+    /**
+     * @brief Number of processes.
+     *
+     */
+    uint64_t size = 1;
+
+    /**
+     * @brief Maximum number of values of allreduce().
+     *
+     */
+    uint64_t count = 0;
+
+    /**
+     * @brief Size of the segment in bytes.
+     *
+     */
+    uint64_t bytes = 0;
+
+    /**
+     * @brief The mapped segment.
+     *
+     */
+    segment_header *header = nullptr;
+};
+
+static_assert(atomic<uint64_t>::is_always_lock_free, "The barrier in shared memory needs lock-free atomics.");
+
+// ==============
+// Implementation
+// ==============
+
+shared_memory_transport::shared_memory_transport(const string &_name, const uint64_t &_rank, const uint64_t &_size, const uint64_t &_count)
+    : name(_name), rank(_rank), size(_size), count(_count)
+{
+    // The header takes one cache line and each process has a slot of count values.
+    bytes = 64 + size * count * sizeof(double);
+#ifdef __linux__
+    int fd = -1;
+    if (rank == 0)
+    {
+        shm_unlink(name.c_str()); // A segment left by a previous run.
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0 || ftruncate(fd, bytes) != 0)
+            throw shared_memory_error(name);
+    }
+    else
+    {
+        // Waiting (up to a minute) for rank 0 to create the segment and set its size.
+        for (uint64_t i = 0; i < 60000; i++)
+        {
+            fd = shm_open(name.c_str(), O_RDWR, 0600);
+            struct stat s;
+            if (fd >= 0 && fstat(fd, &s) == 0 && (uint64_t)s.st_size == bytes)
+                break;
+            if (fd >= 0)
+                close(fd);
+            fd = -1;
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        if (fd < 0)
+            throw shared_memory_error(name);
+    }
+    void *p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        throw shared_memory_error(name);
+    header = static_cast<segment_header *>(p); // The new segment is filled with zeros, which is the initial state of the barrier.
+    barrier();
+#else
+    throw shared_memory_error(name);
+#endif
+}
+
+shared_memory_transport::~shared_memory_transport()
+{
+#ifdef __linux__
+    if (header != nullptr)
+        munmap(header, bytes);
+    if (rank == 0)
+        shm_unlink(name.c_str());
+#endif
+}
+
+uint64_t shared_memory_transport::get_rank() const
+{
+    return rank;
+}
+
+uint64_t shared_memory_transport::get_size() const
+{
+    return size;
+}
+
+double *shared_memory_transport::slot(const uint64_t &r)
+{
+    return reinterpret_cast<double *>(reinterpret_cast<char *>(header) + 64) + r * count;
+}
+
+void shared_memory_transport::barrier()
+{
+    uint64_t generation = header->generation.load(memory_order_acquire);
+    if (header->arrived.fetch_add(1, memory_order_acq_rel) + 1 == size)
+    {
+        // The last process resets the counter and releases the others.
+        header->arrived.store(0, memory_order_relaxed);
+        header->generation.fetch_add(1, memory_order_release);
+    }
+    else
+    {
+        while (header->generation.load(memory_order_acquire) == generation)
+        {
+#ifdef __linux__
+            sched_yield();
+#endif
+        }
+    }
+}
+
+void shared_memory_transport::allreduce(double *values, const uint64_t &n)
+{
+    if (n > count)
+        throw too_many_values();
+    if (size == 1)
+        return;
+    uint64_t left = (rank + size - 1) % size;
+
+    // Start of chunk c of the values.
+    auto chunk_begin = [&](const uint64_t &c)
+    { return c * n / size; };
+
+    // Reduce-scatter: after size - 1 steps, this process has the sum of chunk (rank + 1) % size.
+    for (uint64_t s = 0; s + 1 < size; s++)
+    {
+        uint64_t send = (rank + size - s) % size, receive = (left + size - s) % size;
+        memcpy(slot(rank) + chunk_begin(send), values + chunk_begin(send), (chunk_begin(send + 1) - chunk_begin(send)) * sizeof(double));
+        barrier();
+        const double *incoming = slot(left);
+        for (uint64_t i = chunk_begin(receive); i < chunk_begin(receive + 1); i++)
+            values[i] += incoming[i];
+        barrier(); // The slot is written again in the next step.
+    }
+
+    // Allgather: the summed chunks are passed around the ring.
+    for (uint64_t s = 0; s + 1 < size; s++)
+    {
+        uint64_t send = (rank + 1 + size - s) % size, receive = (rank + size - s) % size;
+        memcpy(slot(rank) + chunk_begin(send), values + chunk_begin(send), (chunk_begin(send + 1) - chunk_begin(send)) * sizeof(double));
+        barrier();
+        memcpy(values + chunk_begin(receive), slot(left) + chunk_begin(receive), (chunk_begin(receive + 1) - chunk_begin(receive)) * sizeof(double));
+        barrier();
+    }
+}